@@ -6,8 +6,26 @@
 #include "lib/differentialdrivetrain.hpp"
 #include "lib/holonomicdrivetrain.hpp"
 #include "lib/drivetrain.hpp"
+#include "lib/motorsampler.hpp"
+#include "lib/thermalgovernor.hpp"
+#include "lib/telemetry.hpp"
+#include "lib/powermanager.hpp"
+#include "lib/blackbox.hpp"
+#include "lib/motorhealth.hpp"
 #include "lib/odometry.hpp"
 #include "lib/pid.hpp"
+#include "lib/exitcondition.hpp"
+#include "lib/purepursuit.hpp"
+#include "lib/motionprofile.hpp"
+#include "lib/trajectory.hpp"
+#include "lib/spline.hpp"
+#include "lib/feedforward.hpp"
+#include "lib/characterization.hpp"
+#include "lib/inputcurve.hpp"
+#include "lib/loopscheduler.hpp"
+#include "lib/ramsete.hpp"
+#include "lib/occupancygrid.hpp"
+#include "lib/pathplanner.hpp"
 #include "lib/trackingwheel.hpp"
 
 #include "util/pose.hpp"
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "blackboxformat.hpp"
+#include "drivetrain.hpp"
+#include "motorsampler.hpp"
+#include "util/pose.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/**
+ * Class that records a match to the SD card as fixed-size binary records (see lib/blackboxformat.hpp).
+ *
+ * Logging a record only copies it into a ring of block-sized buffers in memory. A low-priority task writes each full block to the card
+ * with a single fwrite, so control tasks never wait on the card. Partial blocks are padded and written every flushInterval, so
+ * a brownout or crash loses at most that much of the log.
+ *
+ * Memory use is fixed. If the card falls behind and the ring fills up, the overflow policy decides what is lost:
+ * DROP_OLDEST throws away the oldest unwritten block, while DECIMATE keeps only every other pose and motor record (then every fourth,
+ * and so on) until the card catches up, and only drops records if that isn't enough.
+ *
+ *     BlackBox blackBox;
+ *     blackBox.setMotorSampler(&sampler);
+ *     blackBox.start("/usd/match.bbx");
+ *     blackBox.logPose(chassis.getPose(), chassis.getVelocity());
+ */
+class BlackBox {
+    public:
+        static constexpr size_t BLOCK_COUNT = 8;
+        static constexpr size_t RECORDS_PER_BLOCK = blackbox_format::BLOCK_SIZE / sizeof(BlackBoxRecord);
+        static constexpr uint32_t MAX_DECIMATION = 16;
+
+        enum class OverflowPolicy {
+            DROP_OLDEST,
+            DECIMATE
+        };
+
+    private:
+        using Block = std::array<BlackBoxRecord, RECORDS_PER_BLOCK>;
+
+        // Ring of blocks. The full blocks waiting to be written are followed by the block being filled
+        std::array<Block, BLOCK_COUNT> blocks;
+        Block writeBuffer; // The writer copies a block here so it can write without holding the mutex
+        size_t oldestFull = 0;
+        size_t fullCount = 0;
+        size_t fillCount = 0; // Records in the block being filled
+        pros::Mutex mutex;
+
+        OverflowPolicy policy;
+        uint32_t decimation = 1; // Only every decimation-th pose and motor record is kept
+        uint32_t decimationCounter = 0;
+        uint32_t droppedCount = 0;
+
+        MotorSampler *motorSampler = nullptr;
+        uint32_t lastMotorRecord = 0;
+
+        FILE *file = nullptr;
+        uint32_t flushInterval; // in milliseconds
+        std::atomic<bool> running{false};
+        std::atomic<bool> stopped{true}; // Set by the writer task once the file is closed
+
+        /**
+         * @brief Copies a record into the block being filled.
+         * @param record The record. Its time is set here.
+         */
+        void append(BlackBoxRecord record);
+
+        /**
+         * @brief Takes the oldest full block, or pads and takes the partial block if requested, and writes it to the card.
+         * @param includePartial Whether to write the block being filled if there are no full blocks.
+         * @return Whether a block was written.
+         */
+        bool writeBlock(bool includePartial);
+
+        /**
+         * @brief Logs the latest motor record from the sampler, if there is a new one.
+         */
+        void logMotors();
+
+    public:
+        /**
+         * @brief Construct a new BlackBox object. It is large, so create it once as a global.
+         * @param policy What to lose when the card can't keep up.
+         * @param flushInterval How often partial blocks are written in milliseconds, which is the most a crash can lose.
+         */
+        BlackBox(OverflowPolicy policy = OverflowPolicy::DECIMATE, uint32_t flushInterval = 1000)
+        : policy(policy), flushInterval(flushInterval == 0 ? 1 : flushInterval) {}
+
+        /**
+         * @brief Creates the log file and starts the writer task. Replaces any file with the same name.
+         * @param path The file to write, on the SD card (starting with /usd/).
+         * @param priority The writer task's priority. Keep it below the control tasks.
+         * @return False if a log is already running or the file couldn't be created, such as when no SD card is inserted.
+         */
+        bool start(const char *path, uint32_t priority = TASK_PRIORITY_MIN + 1);
+
+        /**
+         * @brief Writes everything logged so far and closes the file. Blocks until done.
+         */
+        void stop();
+
+        /**
+         * @brief Records the motor records of a sampler, each new record once.
+         * @param sampler The sampler, or nullptr to stop recording motor records.
+         */
+        void setMotorSampler(MotorSampler *sampler) { motorSampler = sampler; }
+
+        /**
+         * @brief Logs the robot's pose and velocity.
+         * @param pose The pose.
+         * @param velocity The velocity, as returned by Chassis::getVelocity().
+         */
+        void logPose(const Pose &pose, const Pose &velocity);
+
+        /**
+         * @brief Logs the commands sent to the drivetrain.
+         * @param commands The command for each motor group.
+         * @param mode How the commands were sent.
+         */
+        void logCommands(const std::array<double, Drivetrain::MAX_MOTOR_GROUPS> &commands, MotorCommand mode);
+
+        /**
+         * @brief Logs sensor readings.
+         * @param id An id that tells sensors apart in the log.
+         * @param values Up to 6 readings.
+         */
+        void logSensor(uint8_t id, const std::array<float, 6> &values);
+
+        /**
+         * @brief Logs an event, such as a detected fault.
+         * @param id An id that tells events apart in the log.
+         * @param values Details of the event.
+         */
+        void logEvent(uint8_t id, const std::array<float, 6> &values = {});
+
+        /**
+         * @brief Get the number of records lost because the card couldn't keep up.
+         * @return The number of records.
+         */
+        uint32_t getDroppedCount() const { return droppedCount; }
+
+        /**
+         * @brief Get how many pose and motor records are kept per record logged, when decimating.
+         * @return 1 when every record is kept.
+         */
+        uint32_t getDecimation() const { return decimation; }
+};
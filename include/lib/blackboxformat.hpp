@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Black box log format.
+ * A log is a header block followed by blocks of fixed-size records, each block BLOCK_SIZE bytes so writes to the SD card stay aligned.
+ * The header sits at the start of the first block, and the rest of that block is zeros.
+ * Blocks are filled up with PADDING records when the recorder flushes early, so a crash loses at most the last partial flush.
+ * A log cut off partway through a record is still readable up to the last whole record.
+ * All fields are little-endian. Logs are indexed and sliced on a computer with tools/blackbox.cpp.
+ */
+namespace blackbox_format {
+    constexpr char MAGIC[4] = {'B', 'B', 'X', 'R'};
+    constexpr uint16_t VERSION = 1;
+    constexpr size_t BLOCK_SIZE = 4096;
+
+    enum RecordType : uint8_t {
+        PADDING = 0, // Fills the rest of a block, skipped by readers
+        POSE = 1, // values: x, y (inches), theta (radians), x velocity, y velocity (inches per second), angular velocity (radians per second)
+        COMMAND = 2, // id: the MotorCommand mode. values: the command sent to each motor group
+        SENSOR = 3, // id: chosen by the caller. values: up to 6 readings
+        MOTOR = 4, // id: the motor's index in the MotorSampler record. values: velocity (RPM), current (mA), voltage (mV), temperature (C), group, connected (0 or 1)
+        EVENT = 5 // id: chosen by the caller. values: details of the event
+    };
+}
+
+#pragma pack(push, 1)
+struct BlackBoxHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t blockSize;
+    uint32_t startTime; // pros::millis() when the log was started
+};
+
+struct BlackBoxRecord {
+    uint32_t time; // pros::micros() truncated to 32 bits
+    uint8_t type;
+    uint8_t id;
+    uint16_t reserved;
+    float values[6];
+};
+#pragma pack(pop)
+
+static_assert(blackbox_format::BLOCK_SIZE % sizeof(BlackBoxRecord) == 0, "Records must fill blocks exactly");
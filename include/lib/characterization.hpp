@@ -0,0 +1,129 @@
+#pragma once
+
+#include "chassis.hpp"
+#include "feedforward.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Parameters for a characterization run.
+ * Values set to 0 disable their respective functionality.
+ */
+struct CharacterizationParams {
+    double rampRate = 2.5; // How fast the motor speed rises during the quasistatic tests (motor speed units per second)
+    double stepSpeed = 60; // The motor speed the dynamic tests jump to (0 - 127)
+    double maxDistance = 48; // Each driving test ends once the robot has driven this far (inches)
+    int maxTime = 8000; // Each driving test ends after this long (ms)
+    double minVelocity = 1; // Samples slower than this are left out of the fit, since the robot hasn't broken away from static friction (inches per second)
+    double turnSpeed = 40; // The motor speed for the track width test (0 - 127). Set to 0 to skip it
+    int turnTime = 4000; // How long the track width test spins for (ms)
+    int restTime = 1000; // How long the robot rests between tests so it comes to a stop (ms)
+    bool apply = false; // Whether to set the chassis' feedforward and the drivetrain's track width from the results
+};
+
+/**
+ * One logged sample of a driving test.
+ */
+struct CharacterizationSample {
+    uint32_t time; // Time since the test started (ms)
+    float command; // The motor speed sent (-127 to 127)
+    float position; // Distance driven along the robot's starting heading (inches)
+    float velocity; // Velocity along the robot's starting heading (inches per second)
+};
+
+/**
+ * Results of a characterization run.
+ */
+struct CharacterizationResult {
+    Feedforward feedforward; // The fitted kS, kV and kA, in the same units the chassis uses
+    double rSquared = 0; // How well the model fits the samples (0 - 1). Values below about 0.9 suggest noisy or too few samples
+    size_t fittedSamples = 0; // The number of samples used in the fit
+    double trackWidth = 0; // The effective track width found from the IMU and wheel travel (inches), 0 if the test was skipped
+    bool valid = false; // Whether the fit succeeded
+};
+
+/**
+ * Class that measures the drivetrain's feedforward model and effective track width.
+ *
+ * The characterization drives the robot forwards and backwards with slowly rising motor speeds (quasistatic tests)
+ * and with sudden steps (dynamic tests), logging the command, position and velocity every time the tracking task updates.
+ * kS, kV and kA are then fit to the samples by least squares.
+ * Finally the robot spins in place, and the effective track width is found from how far the wheels traveled for the rotation the IMU measured.
+ * This is usually wider than the measured track width, because of wheel scrub.
+ *
+ * The robot needs about maxDistance inches of clear space in front of it. Acceleration limits on the drivetrain should be disabled first.
+ * The log is preallocated and large, so create the characterizer once as a global:
+ *
+ *     Characterizer characterizer(&chassis);
+ *     CharacterizationResult result = characterizer.run();
+ */
+class Characterizer {
+    public:
+        static constexpr size_t MAX_SAMPLES = 2048;
+
+    private:
+        // Running sums of the least squares normal equations, for the model command = kS * sign(v) + kV * v + kA * a
+        struct FitSums {
+            std::array<std::array<double, 3>, 3> xx = {}; // Sums of each pair of terms
+            std::array<double, 3> xy = {}; // Sums of each term times the command
+            double yy = 0; // Sum of the squared commands
+            double y = 0; // Sum of the commands
+            size_t count = 0;
+        };
+
+        Chassis *chassis;
+        std::array<CharacterizationSample, MAX_SAMPLES> samples;
+        size_t sampleCount = 0;
+
+        /**
+         * @brief Runs one driving test and logs its samples.
+         * @param direction 1 to drive forwards, -1 to drive backwards.
+         * @param quasistatic True for a quasistatic test (rising speed), false for a dynamic test (speed step).
+         * @param params The characterization parameters.
+         * @return The index of the test's first sample.
+         */
+        size_t runDriveTest(double direction, bool quasistatic, const CharacterizationParams &params);
+
+        /**
+         * @brief Adds the samples of one test to the least squares sums. Accelerations are found by differencing neighbouring velocities.
+         * @param first The index of the test's first sample.
+         * @param last One past the index of the test's last sample.
+         * @param minVelocity Samples slower than this are skipped.
+         * @param sums The running sums.
+         */
+        void accumulate(size_t first, size_t last, double minVelocity, FitSums &sums) const;
+
+        /**
+         * @brief Spins the robot in place and finds the effective track width.
+         * @param params The characterization parameters.
+         * @return The effective track width in inches, or 0 if the robot didn't turn.
+         */
+        double runTrackWidthTest(const CharacterizationParams &params);
+
+    public:
+        /**
+         * @brief Construct a new Characterizer object.
+         * @param chassis The chassis to characterize. It must have odometry with an IMU.
+         */
+        Characterizer(Chassis *chassis) : chassis(chassis) {}
+
+        /**
+         * @brief Runs every test and fits the results. Blocks until done, which takes about half a minute. Don't run other motions at the same time.
+         * @param params The characterization parameters.
+         * @return The fitted model and track width.
+         */
+        CharacterizationResult run(CharacterizationParams params = {});
+
+        /**
+         * @brief Get the samples logged by the last run, for printing or plotting.
+         * @return The first logged sample.
+         */
+        const CharacterizationSample *getSamples() const { return samples.data(); }
+
+        /**
+         * @brief Get the number of samples logged by the last run.
+         * @return The number of samples.
+         */
+        size_t getSampleCount() const { return sampleCount; }
+};
@@ -2,25 +2,157 @@
 #include "drivetrain.hpp"
 #include "odometry.hpp"
 #include "pid.hpp"
+#include "exitcondition.hpp"
+#include "purepursuit.hpp"
+#include "feedforward.hpp"
+#include "inputcurve.hpp"
 #include "util/pose.hpp"
 #include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+
+/**
+ * Parameters for a moveToPose motion.
+ * Values set to 0 disable their respective functionality.
+ */
+struct MoveToPoseParams {
+    bool forwards = true; // Whether the robot drives into the target forwards (true) or backwards (false). Differential chassis only
+    double lead = 0.6; // How far the carrot point is placed behind the target, as a fraction of the remaining distance (0 - 1). Differential chassis only
+    double horizontalDrift = 0; // Limits speed through curves to sqrt(horizontalDrift * radius), higher values allow faster curves. Differential chassis only
+    double maxSpeed = 127; // The maximum motor speed (0 - 127)
+    double minSpeed = 0; // Exit speed. The robot drives at least this fast (0 - 127), exits once it passes the target, and doesn't stop at the end
+    double earlyExitRange = 0; // Exits as soon as the robot is this close to the target (inches), without settling or stopping
+    double maxVelocity = 0; // Max velocity of the translation profile in inches per second. Holonomic chassis only
+    double maxAcceleration = 0; // Max acceleration of the translation profile in inches per second squared. Holonomic chassis only
+    int smallErrorTime = 100; // How long the lateral error has to stay within the lateral PID's small error range to exit (ms)
+    int largeErrorTime = 500; // How long the lateral error has to stay within the lateral PID's large error range to exit (ms)
+};
+
+/**
+ * The side of the robot that is held still during a turn.
+ * NONE turns in place, LEFT and RIGHT swing around the locked side.
+ */
+enum class SwingSide {
+    NONE,
+    LEFT,
+    RIGHT
+};
+
+/**
+ * Parameters for a turn.
+ * Values set to 0 disable their respective functionality.
+ */
+struct TurnParams {
+    bool forwards = true; // For turnToPoint, whether the front (true) or back (false) of the robot faces the point
+    SwingSide lockedSide = SwingSide::NONE; // The side held still for a swing turn
+    double maxSpeed = 127; // The maximum motor speed (0 - 127)
+    double minSpeed = 0; // Exit speed. The robot turns at least this fast (0 - 127), exits once it passes the target, and doesn't stop at the end
+    double earlyExitRange = 0; // Exits as soon as the heading is this close to the target (degrees), without settling or stopping
+    int smallErrorTime = 100; // How long the error has to stay within the turn PID's small error range to exit (ms)
+    int largeErrorTime = 500; // How long the error has to stay within the turn PID's large error range to exit (ms)
+};
+
+/**
+ * A heading published by the tracking task, with when it was measured.
+ */
+struct HeadingSample {
+    double heading = 0; // in radians, same convention as the tracked pose
+    double rate = 0; // Yaw rate in radians per second
+    uint32_t timestamp = 0; // When the heading was measured, from pros::micros()
+};
+
+/**
+ * Results of the last completed turn, used for tuning.
+ */
+struct TurnResult {
+    int settleTime = 0; // Time from the start of the turn until it exited (ms)
+    double finalError = 0; // Heading error when the turn exited (degrees)
+    double overshoot = 0; // Furthest the robot turned past the target (degrees)
+    bool timedOut = false; // Whether the turn was ended by the timeout instead of settling
+};
 
 class Chassis {
+    public:
+        static constexpr size_t MAX_QUEUED_MOTIONS = 8;
+        static constexpr size_t MAX_MOTION_WAITERS = 4;
+
+    private:
+        /**
+         * A task blocked in waitUntilDone or waitUntilDistance.
+         */
+        struct MotionWaiter {
+            pros::task_t task = nullptr;
+            double distance = 0; // Woken once the running motion has traveled this far (inches). 0 only wakes when motions finish
+        };
+
+        // Motions waiting to run, in order. Only touched while holding motionMutex
+        std::array<std::function<void()>, MAX_QUEUED_MOTIONS> motionQueue;
+        size_t queueStart = 0;
+        size_t queueSize = 0;
+        std::array<MotionWaiter, MAX_MOTION_WAITERS> waiters;
+        pros::Mutex motionMutex;
+        pros::task_t motionTask = nullptr;
+
+        // Progress of the motions, used to decide when waiters are done
+        uint32_t motionsStarted = 0;
+        uint32_t motionsFinished = 0;
+        bool motionRunning = false;
+        double motionDistance = 0; // Distance traveled since the running motion started (inches)
+
+        /**
+         * @brief Starts the motion task if it is not already running.
+         * The task sleeps until notified that a motion was queued, then runs queued motions until the queue is empty.
+         */
+        void startMotionTask();
+
+        /**
+         * @brief Wakes waiting tasks. Must be called while holding motionMutex.
+         * @param finished True if a motion just finished, which wakes every waiter. Otherwise only waiters whose distance has been reached are woken.
+         */
+        void notifyWaiters(bool finished);
+
+        /**
+         * @brief Blocks the calling task until a motion has finished or, if distance is set, the running motion has traveled that far.
+         * @param distance The distance in inches. Set to 0 to wait until the motion has finished.
+         * @param allMotions If true, waits until every queued motion has finished instead of only the current one.
+         */
+        void waitForMotion(double distance, bool allMotions);
+
+        friend class Characterizer;
+
     protected:
         Drivetrain *drivetrain;
         Odometry *odometry;
 
         Pose *pose;
+        Pose velocity; // Field-relative velocity in inches per second, theta in radians per second
         PIDController *lateralPID;
         PIDController *turnPID;
+        Feedforward feedforward;
+        InputCurve inputCurve;
+
+        // Published by the tracking task. The sequence is odd while the sample is being written, so readers can detect torn reads
+        HeadingSample headingSample;
+        std::atomic<uint32_t> headingSequence{0};
 
         bool tracking = false;
+        bool inMotion = false; // True while any motion is running or queued
+        bool cancelRequested = false; // Checked by motion loops every iteration, they exit early when it is set
+        TurnResult lastTurnResult;
 
         /**
          * @brief Calculate the robot's current position based on the odometry sensors. Runs constantly in parallel with other tasks.
         */
         void trackPosition();
 
+        /**
+         * @brief Publishes the latest heading for other tasks. Only called by the tracking task.
+         * @param heading The heading in radians.
+         * @param rate The yaw rate in radians per second.
+         */
+        void publishHeading(double heading, double rate);
+
         /**
          * @brief Starts the tracking task if it is not already running.
          */
@@ -28,19 +160,76 @@ class Chassis {
             tracking = true;
             pros::Task trackingTask([this]
             {
+                uint32_t previousTime = pros::millis();
                 while (true) {
+                    Pose previousPose = getPose();
                     trackPosition();
+                    Pose currentPose = getPose();
+                    updateMotionDistance(previousPose.distanceTo(currentPose));
+
+                    uint32_t currentTime = pros::millis();
+                    double dt = (currentTime - previousTime) / 1000.0;
+                    previousTime = currentTime;
+                    if (dt > 0) {
+                        velocity = Pose((currentPose.getX() - previousPose.getX()) / dt,
+                                        (currentPose.getY() - previousPose.getY()) / dt,
+                                        (currentPose.getTheta() - previousPose.getTheta()) / dt);
+                    }
+                    publishHeading(currentPose.getTheta(), velocity.getTheta());
+
                     pros::delay(20); // avoid tight loop
                 }
             });
         }
 
         /**
-         * @brief Scales an input value based on the selected input scaling method.
-         * @param input The input value to scale (-127 to 127). 
+         * @brief Scales an input value based on the selected input curve. This is a single table lookup.
+         * @param input The input value to scale (-127 to 127). Values outside the range are clamped.
          * @return The scaled input value.
          */
-        double scaleInput(int input);
+        double scaleInput(int input) const { return inputCurve(input); }
+
+        /**
+         * @brief Adds the distance the robot moved to the running motion's progress and wakes any tasks waiting on it.
+         * @param distance The distance moved since the last update (inches).
+         */
+        void updateMotionDistance(double distance);
+
+        /**
+         * @brief Queues a motion to run on the motion task once all previously queued motions have finished.
+         * @param motion The motion loop to run. It should exit early once cancelRequested is set.
+         * @param async If true, this function returns as soon as the motion is queued. Otherwise it blocks until the motion has finished.
+         */
+        void runMotion(std::function<void()> motion, bool async);
+
+        /**
+         * @brief The control loop shared by all turns. Blocks until the turn has settled or timed out.
+         * @param targetHeading Returns the heading to turn to (in radians). Evaluated every iteration.
+         * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+         * @param params The turn parameters.
+         */
+        void turnLoop(std::function<double()> targetHeading, int timeout, TurnParams params);
+
+        /**
+         * @brief Applies a turning speed to the drivetrain. Positive speeds increase the heading.
+         * @param speed The turning speed (-127 to 127).
+         * @param lockedSide The side of the robot to hold still, or NONE to turn in place.
+         */
+        void virtual setTurnSpeed(double speed, SwingSide lockedSide) = 0;
+
+        /**
+         * @brief Applies a straight driving speed to the drivetrain. Positive speeds drive forwards.
+         * @param speed The driving speed (-127 to 127).
+         */
+        void virtual setDriveSpeed(double speed) = 0;
+
+        /**
+         * @brief Calculates the lookahead distance for a target speed.
+         * @param velocity The target motor speed (0 - 127).
+         * @param params The pure pursuit parameters.
+         * @return The lookahead distance in inches, between params.minLookahead and params.maxLookahead.
+         */
+        double getLookahead(double velocity, PurePursuitParams params);
 
     public:
         enum InputScale {
@@ -53,12 +242,12 @@ class Chassis {
             XTAN
         };
 
-        InputScale inputScale = LINEAR;
-
+        Chassis(Drivetrain *drivetrain, Odometry *odometry, PIDController *lateralPID, PIDController *turnPID)
+        : drivetrain(drivetrain), odometry(odometry), pose(new Pose()), lateralPID(lateralPID), turnPID(turnPID) {}
         Chassis(Drivetrain *drivetrain, Odometry *odometry)
-        : drivetrain(drivetrain), odometry(odometry), pose(new Pose()) {}
+        : drivetrain(drivetrain), odometry(odometry), pose(new Pose()), lateralPID(nullptr), turnPID(nullptr) {}
         Chassis(Drivetrain *drivetrain) 
-        : drivetrain(drivetrain), odometry(nullptr) {}
+        : drivetrain(drivetrain), odometry(nullptr), pose(new Pose()), lateralPID(nullptr), turnPID(nullptr) {}
  
         /**
          * @brief Sets the input scaling method. The input scaling affects how joystick inputs are translated to motor speeds.
@@ -83,6 +272,18 @@ class Chassis {
          */
         void setInputScale(InputScale scale);
 
+        /**
+         * @brief Sets a custom input curve, such as InputCurve::exponential or InputCurve::piecewiseLinear.
+         * @param curve The input curve to use.
+         */
+        void setInputCurve(const InputCurve &curve);
+
+        /**
+         * @brief Sets the drivetrain feedforward model used by velocity-controlled motions.
+         * @param feedforward The feedforward model.
+         */
+        void setFeedforward(Feedforward feedforward);
+
         /**
          * @brief Resets the pose and all of the robot's sensors to their initial state.
          */
@@ -99,6 +300,25 @@ class Chassis {
          */
         Pose getPose() const;
 
+        /**
+         * @brief Get the robot's current velocity, measured by the tracking task.
+         * @return The field-relative velocity in inches per second, with theta in radians per second.
+         */
+        Pose getVelocity() const { return velocity; }
+
+        /**
+         * @brief Get the last heading published by the tracking task, without any device calls.
+         * @return The heading, yaw rate, and when the heading was measured.
+         */
+        HeadingSample getHeadingSample() const;
+
+        /**
+         * @brief Get the heading predicted for the current time, extrapolating the last published heading with the yaw rate.
+         * This makes up for the time since the tracking task last ran, without any device calls.
+         * @return The predicted heading in radians.
+         */
+        double getPredictedHeading() const;
+
         /**
          * @brief Set the robot's current pose (position and orientation).
          * @param newPose The new pose to set.
@@ -119,17 +339,81 @@ class Chassis {
          */
         void setBrakeMode(pros::motor_brake_mode_e_t mode);
 
+        /**
+         * @brief Returns whether a motion is currently running or queued.
+         * @return True if a motion is running or queued, false otherwise.
+         */
+        bool isInMotion() const { return inMotion; }
+
+        /**
+         * @brief Blocks the calling task until every queued motion has finished.
+         */
+        void waitUntilDone();
+
+        /**
+         * @brief Blocks the calling task until the running motion has traveled a distance, or has finished.
+         * If no motion has started yet, waits on the next queued motion. Returns immediately if nothing is queued.
+         * 
+         * Example: start a drive asynchronously, then raise the intake 20 inches into it.
+         * 
+         *     chassis.moveToPose(Pose(0, 48, 0), 3000, {}, true);
+         *     chassis.waitUntilDistance(20);
+         *     intake.move(127);
+         * 
+         * @param distance The distance traveled since the motion started (inches).
+         */
+        void waitUntilDistance(double distance);
+
+        /**
+         * @brief Ends the running motion early and clears every queued motion.
+         */
+        void cancel();
+
         /**
          * @brief Move the robot to a specific position using PID control.
          * @param targetPose The target pose to move to.
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The motion parameters.
+         * @param async If true, the motion runs in the background and this function returns immediately.
          */
-        void virtual moveToPose(Pose targetPose) = 0;
+        void virtual moveToPose(Pose targetPose, int timeout = 0, MoveToPoseParams params = {}, bool async = false) = 0;
 
         /**
          * @brief Turn the robot to a specific angle using PID control.
-         * 0 Degrees is facing "forward" from the starting orientation.
+         * 0 Degrees is facing "forward" from the starting orientation. The robot turns whichever way is shorter.
          * 
          * @param targetAngle The target angle to turn to (in degrees).
+         * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+         * @param params The turn parameters. Set lockedSide for a swing turn.
+         * @param async If true, the turn runs in the background and this function returns immediately.
+         */
+        void virtual turnAngle(double targetAngle, int timeout = 0, TurnParams params = {}, bool async = false) = 0;
+
+        /**
+         * @brief Follow a path of waypoints using pure pursuit.
+         * The robot steers towards a lookahead point on the path. The lookahead distance grows with the target speed,
+         * and the target speed is taken from the waypoint closest to the robot.
+         * 
+         * @param path The waypoints to follow, spaced closely together (a few inches apart).
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The pure pursuit parameters.
+         * @param async If true, the motion runs in the background and this function returns immediately.
+         */
+        void virtual followPath(std::vector<Waypoint> path, int timeout = 0, PurePursuitParams params = {}, bool async = false) = 0;
+
+        /**
+         * @brief Turn the robot to face a point on the field using PID control.
+         * @param x The x-coordinate of the point (in inches).
+         * @param y The y-coordinate of the point (in inches).
+         * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+         * @param params The turn parameters. Set forwards to false to face the point with the back of the robot.
+         * @param async If true, the turn runs in the background and this function returns immediately.
+         */
+        void turnToPoint(double x, double y, int timeout = 0, TurnParams params = {}, bool async = false);
+
+        /**
+         * @brief Get the results of the last completed turn (settle time, final error and overshoot).
+         * @return The results of the last turn.
          */
-        void virtual turnAngle(double targetAngle) = 0;
+        TurnResult getLastTurnResult() const { return lastTurnResult; }
 };
\ No newline at end of file
@@ -2,13 +2,61 @@
 
 #include "differentialdrivetrain.hpp"
 #include "chassis.hpp"
+#include "ramsete.hpp"
+#include "trajectory.hpp"
 #include "odometry.hpp"
 #include "pid.hpp"
 #include "util/pose.hpp"
 #include "pros/rtos.hpp"
 
 class DifferentialChassis : public Chassis {
+    private:
+        /**
+         * @brief The control loop behind moveToPose. Blocks until the motion has finished.
+         * @param targetPose The target pose to move to.
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The motion parameters.
+         */
+        void moveToPoseLoop(Pose targetPose, int timeout, MoveToPoseParams params);
+
+        /**
+         * @brief Applies a turning speed to the drivetrain. Positive speeds increase the heading.
+         * @param speed The turning speed (-127 to 127).
+         * @param lockedSide The side of the robot to hold still, or NONE to turn in place.
+         */
+        void setTurnSpeed(double speed, SwingSide lockedSide) override;
+
+        /**
+         * @brief Applies a straight driving speed to the drivetrain. Positive speeds drive forwards.
+         * @param speed The driving speed (-127 to 127).
+         */
+        void setDriveSpeed(double speed) override;
+
+        /**
+         * @brief The control loop behind followPath. Blocks until the path has finished.
+         * @param path The waypoints to follow.
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The pure pursuit parameters.
+         */
+        void followPathLoop(std::vector<Waypoint> path, int timeout, PurePursuitParams params);
+
+        /**
+         * @brief The control loop behind followTrajectory. Blocks until the trajectory has finished.
+         * @param trajectory The trajectory to follow.
+         * @param params The RAMSETE parameters.
+         */
+        void followTrajectoryLoop(const Trajectory *trajectory, RamseteParams params);
+
+        /**
+         * @brief Get the measured velocity of each side of the drivetrain.
+         * @return The left and right velocities in inches per second.
+         */
+        std::array<double, 2> getSideVelocities();
+
     public:
+        DifferentialChassis(DifferentialDrivetrain *drivetrain, Odometry *odometry, PIDController *lateralPID, PIDController *turnPID) 
+        : Chassis(drivetrain, odometry, lateralPID, turnPID) {}
+
         DifferentialChassis(DifferentialDrivetrain *drivetrain, Odometry *odometry) 
         : Chassis(drivetrain, odometry) {}
 
@@ -30,16 +78,47 @@ class DifferentialChassis : public Chassis {
         void tank(int leftY, int rightY);
 
         /**
-         * @brief Move the robot to a specific position using PID control.
+         * @brief Move the robot to a specific pose using a boomerang controller.
+         * The robot chases a carrot point placed behind the target along its heading, which curves the path so the robot arrives facing the target heading.
+         * The lateral PID drives the distance to the carrot point and the turn PID drives the heading error.
+         * 
          * @param targetPose The target pose to move to.
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The motion parameters.
+         * @param async If true, the motion runs in the background and this function returns immediately.
+         */
+        void moveToPose(Pose targetPose, int timeout = 0, MoveToPoseParams params = {}, bool async = false) override;
+
+        /**
+         * @brief Follow a path of waypoints using pure pursuit.
+         * The robot drives the arc that passes through the lookahead point.
+         * 
+         * @param path The waypoints to follow, spaced closely together (a few inches apart).
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The pure pursuit parameters.
+         * @param async If true, the motion runs in the background and this function returns immediately.
+         */
+        void followPath(std::vector<Waypoint> path, int timeout = 0, PurePursuitParams params = {}, bool async = false) override;
+
+        /**
+         * @brief Follow a time-parameterized trajectory using a RAMSETE controller.
+         * The corrected velocities are converted to wheel velocities and sent to each side through the feedforward model,
+         * plus optional per-side velocity feedback. The robot's pose should match the trajectory's start pose.
+         * 
+         * @param trajectory The trajectory to follow. It must stay alive until the motion has finished.
+         * @param params The RAMSETE parameters.
+         * @param async If true, the motion runs in the background and this function returns immediately.
          */
-        void moveToPose(Pose targetPose) override;
+        void followTrajectory(const Trajectory &trajectory, RamseteParams params = {}, bool async = false);
 
         /**
          * @brief Turn the robot to a specific angle using PID control.
-         * 0 Degrees is facing "forward" from the starting orientation.
+         * 0 Degrees is facing "forward" from the starting orientation. The robot turns whichever way is shorter.
          * 
          * @param targetAngle The target angle to turn to (in degrees).
+         * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+         * @param params The turn parameters. Set lockedSide for a swing turn.
+         * @param async If true, the turn runs in the background and this function returns immediately.
          */
-        void turnAngle(double targetAngle) override;
+        void turnAngle(double targetAngle, int timeout = 0, TurnParams params = {}, bool async = false) override;
 };
\ No newline at end of file
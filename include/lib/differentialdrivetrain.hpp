@@ -26,6 +26,7 @@ class DifferentialDrivetrain : public Drivetrain {
          * @param limit The current limit in milliamps.
         */
         void setCurrentLimit(int32_t limit) override;
+        using Drivetrain::setCurrentLimit;
 
         /**
          * Returns the brake mode of the drivetrain.
@@ -58,7 +59,24 @@ class DifferentialDrivetrain : public Drivetrain {
         std::vector<pros::MotorGroup*> getMotors() override;
 
         /**
-         * Sets the speeds of the motors based on the speeds given
+         * Fills an array with the motor groups on this drivetrain, in the order of getMotors(), without allocating.
+         * 
+         * @param groups The array to fill.
+         * @return The number of motor groups.
+         */
+        size_t getMotors(std::array<pros::MotorGroup*, MAX_MOTOR_GROUPS> &groups) override;
+
+        /**
+         * Returns how many motor groups, from the start of getMotors(), turn the robot in place.
+         */
+        size_t getTurningMotorCount() override;
+
+        /**
+         * Sends a command to every motor group, in the order of getMotors().
+         * 
+         * @param commands The command for each motor group.
+         * @param mode How the commands are sent: motor speed, voltage, or closed-loop velocity.
          */
-        void setMotorSpeeds(std::initializer_list<int> speeds) override;
+        void setMotorSpeeds(const std::array<double, MAX_MOTOR_GROUPS> &commands, MotorCommand mode) override;
+        using Drivetrain::setMotorSpeeds;
 };
\ No newline at end of file
@@ -1,15 +1,91 @@
 #pragma once
 
+#include "pros/imu.hpp"
 #include "pros/motor_group.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <vector>
 #include <initializer_list>
 
+/**
+ * How the values passed to Drivetrain::setMotorSpeeds are sent to the motors.
+ */
+enum class MotorCommand {
+    SPEED, // Motor speed (-127 to 127), the same scale as pros::Motor::move, sent as a voltage so fractions aren't lost
+    VOLTAGE, // Voltage in millivolts (-12000 to 12000)
+    VELOCITY // Closed-loop velocity in RPM, using the motors' built-in velocity controller
+};
+
+/**
+ * Readings from one motor, taken together.
+ */
+struct MotorSnapshot {
+    double temperature; // in degrees Celsius
+    double velocity; // in RPM
+    int32_t currentDraw; // in milliamps
+    int32_t voltage; // in millivolts
+};
+
+/**
+ * Readings from every motor on a drivetrain, in fixed-capacity arrays so no memory is allocated.
+ * Motor groups are in the order of Drivetrain::getMotors().
+ */
+struct DrivetrainSnapshot {
+    static constexpr size_t MAX_GROUPS = 5;
+    static constexpr size_t MAX_MOTORS_PER_GROUP = 8;
+
+    struct Group {
+        size_t motorCount;
+        std::array<MotorSnapshot, MAX_MOTORS_PER_GROUP> motors;
+    };
+
+    uint32_t timestamp; // When the readings were taken, from pros::millis()
+    size_t groupCount;
+    std::array<Group, MAX_GROUPS> groups;
+};
+
 class Drivetrain {
+    public:
+        static constexpr size_t MAX_MOTOR_GROUPS = 5;
+
     protected: 
         double wheelDiameter;
         double wheelTrackWidth;
         double gearRatio;
 
+        // Acceleration limiter settings, in motor speed units (0 - 127) per second. 0 disables a limit
+        double maxAcceleration = 0;
+        double maxDeceleration = 0;
+
+        // Anti-tip governor settings
+        pros::IMU *tipImu = nullptr;
+        double tipStartAngle = 0; // in degrees
+        double tipMaxAngle = 0; // in degrees
+        double tipMinScale = 1;
+
+        // Limiter state: the last output of each motor group in motor speed units, and the largest change allowed this update
+        std::array<double, MAX_MOTOR_GROUPS> limitedSpeeds = {};
+        uint32_t lastLimitTime = 0;
+        double accelerationStep = 0;
+        double decelerationStep = 0;
+
+        /**
+         * @brief Works out how much each motor group's output may change this update, from the time since the last update and the robot's tilt.
+         * Call once at the start of setMotorSpeeds, before sendCommand.
+         */
+        void updateLimiter();
+
+        /**
+         * @brief Sends a command to a motor group, after limiting how fast its output changes.
+         * @param index The motor group's index in getMotors(), which selects its limiter state.
+         * @param motors The motor group.
+         * @param command The command value, in the units of the mode.
+         * @param mode How the command is sent.
+         */
+        void sendCommand(size_t index, pros::MotorGroup *motors, double command, MotorCommand mode);
+
     public:
 
         Drivetrain(double wheelDiameter, double wheelTrackWidth, double gearRatio)
@@ -50,6 +126,42 @@ class Drivetrain {
          */
         void setGearRatio(double ratio) { gearRatio = ratio; }
 
+        /**
+         * Limits how fast each motor group's output can change, so the drivetrain doesn't jump from 0 to full speed (or back) instantly.
+         * The limits apply to every command sent through setMotorSpeeds, in any mode.
+         * Deceleration applies when an output shrinks or reverses direction, acceleration when it grows.
+         * 
+         * @param acceleration The largest increase in motor speed (0 - 127) per second. 0 disables the limit.
+         * @param deceleration The largest decrease in motor speed (0 - 127) per second. 0 disables the limit.
+         */
+        void setAccelerationLimits(double acceleration, double deceleration) {
+            maxAcceleration = std::abs(acceleration);
+            maxDeceleration = std::abs(deceleration);
+        }
+
+        /**
+         * Reduces the acceleration limits when the robot starts tipping, measured by the IMU's pitch and roll.
+         * Between startAngle and maxAngle of tilt, the limits are scaled down linearly until they reach minScale of their set values.
+         * Has no effect on limits that are disabled.
+         * 
+         * @param imu The IMU to read pitch and roll from, or nullptr to disable the governor.
+         * @param startAngle The tilt in degrees where the limits start to be reduced.
+         * @param maxAngle The tilt in degrees where the limits are reduced the most.
+         * @param minScale The fraction of the limits left at maxAngle (0 - 1).
+         */
+        void setTipGovernor(pros::IMU *imu, double startAngle, double maxAngle, double minScale = 0.25) {
+            tipImu = imu;
+            tipStartAngle = startAngle;
+            tipMaxAngle = maxAngle;
+            tipMinScale = std::clamp(minScale, 0.0, 1.0);
+        }
+
+        /**
+         * Forgets the limiter's previous outputs, so the next command is sent without being limited.
+         * Used when stopping the robot outright.
+         */
+        void resetLimiter() { limitedSpeeds.fill(0); }
+
         /**
          * Sets the brake mode of the drivetrain.
          */
@@ -62,6 +174,14 @@ class Drivetrain {
         */
         void virtual setCurrentLimit(int32_t limit) = 0;
 
+        /**
+         * Sets the current limit for the motors in one motor group.
+         * 
+         * @param group The motor group's index in getMotors().
+         * @param limit The current limit in milliamps.
+         */
+        void setCurrentLimit(size_t group, int32_t limit);
+
         /**
          * Returns the brake mode of the drivetrain.
          */
@@ -93,7 +213,48 @@ class Drivetrain {
         std::vector<pros::MotorGroup*> virtual getMotors() = 0;
 
         /**
-         * Sets the speeds of the motors based on the speeds given
+         * Fills an array with the motor groups on this drivetrain, in the order of getMotors(), without allocating.
+         * 
+         * @param groups The array to fill.
+         * @return The number of motor groups.
+         */
+        size_t virtual getMotors(std::array<pros::MotorGroup*, MAX_MOTOR_GROUPS> &groups) = 0;
+
+        /**
+         * Returns how many motor groups, from the start of getMotors(), turn the robot in place.
+         * Groups after them, such as an H-drive's strafe wheels, stay still while turning.
+         */
+        size_t virtual getTurningMotorCount() = 0;
+
+        /**
+         * Reads the temperature, velocity, current draw and voltage of every motor in a single pass, without allocating.
+         * Prefer this over the separate getters when logging more than one reading.
+         * 
+         * @param snapshot The snapshot to fill.
+         */
+        void getSnapshot(DrivetrainSnapshot &snapshot);
+
+        /**
+         * Sends a command to every motor group, in the order of getMotors().
+         * Groups without a command are sent 0.
+         * 
+         * @param commands The command for each motor group.
+         * @param mode How the commands are sent: motor speed, voltage, or closed-loop velocity.
+         */
+        void virtual setMotorSpeeds(const std::array<double, MAX_MOTOR_GROUPS> &commands, MotorCommand mode) = 0;
+
+        /**
+         * Sets the speeds of the motors based on the speeds given (-127 to 127), in the order of getMotors().
          */
-        void virtual setMotorSpeeds(std::initializer_list<int> speeds) = 0;
+        void setMotorSpeeds(std::initializer_list<int> speeds) {
+            std::array<double, MAX_MOTOR_GROUPS> commands = {};
+            size_t i = 0;
+            for (int speed : speeds) {
+                if (i == MAX_MOTOR_GROUPS) {
+                    break;
+                }
+                commands[i++] = speed;
+            }
+            setMotorSpeeds(commands, MotorCommand::SPEED);
+        }
 };
@@ -0,0 +1,54 @@
+#pragma once
+
+/**
+ * Class representing an exit condition for a motion.
+ * The condition is met once the error has stayed within the range for the given amount of time.
+ * 
+ * For usage, the update method should be placed inside of the motion loop alongside the PID controller's calculate method.
+ * Typically two exit conditions are used per motion: a small range with a short time and a large range with a longer time.
+ */
+class ExitCondition {
+    private:
+        double range;
+        int time; // in milliseconds
+        int enterTime = -1; // time the error entered the range, -1 if it is outside of the range
+        bool done = false;
+
+    public:
+        /**
+         * Constructor for the exit condition.
+         * 
+         * @param range the error range in the same units as the error. Set to 0 to disable.
+         * @param time how long the error has to stay within the range in milliseconds
+         */
+        ExitCondition(double range, int time) : range(range), time(time) {}
+
+        /**
+         * Sets the range and time for the exit condition.
+         * 
+         * @param range the error range in the same units as the error. Set to 0 to disable.
+         * @param time how long the error has to stay within the range in milliseconds
+         */
+        void setExit(double range, int time);
+
+        /**
+         * Updates the exit condition with the current error.
+         * 
+         * @param error the current error
+         * @return whether or not the exit condition has been met
+         */
+        bool update(double error);
+
+        /**
+         * Gets whether the exit condition has been met.
+         * 
+         * @return whether or not the exit condition has been met
+         */
+        bool getExit() { return done; }
+
+        /**
+         * Resets the exit condition.
+         * It is highly recommended to call this method before starting a new motion.
+         */
+        void reset();
+};
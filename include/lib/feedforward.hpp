@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * Class representing a drivetrain feedforward model.
+ * The motor command needed to hold a velocity and acceleration is modelled as kS * sign(velocity) + kV * velocity + kA * acceleration.
+ * kS overcomes static friction, kV holds the velocity against back-EMF, and kA accelerates the robot's mass.
+ * 
+ * Gains are in motor command units (-127 to 127) per inch per second (kV) and per inch per second squared (kA).
+ */
+class Feedforward {
+    private:
+        double kS;
+        double kV;
+        double kA;
+
+    public:
+        /**
+         * Constructor for the feedforward model.
+         * 
+         * @param kS the static friction gain
+         * @param kV the velocity gain
+         * @param kA the acceleration gain
+         */
+        Feedforward(double kS, double kV, double kA) : kS(kS), kV(kV), kA(kA) {}
+
+        /**
+         * Default constructor for the feedforward model.
+         * Sets the gains to 0.
+         */
+        Feedforward() : kS(0), kV(0), kA(0) {}
+
+        /**
+         * Sets the gains for the feedforward model.
+         * 
+         * @param kS the static friction gain
+         * @param kV the velocity gain
+         * @param kA the acceleration gain
+         */
+        void setGains(double kS, double kV, double kA) {
+            this->kS = kS;
+            this->kV = kV;
+            this->kA = kA;
+        }
+
+        double getS() const { return kS; }
+        double getV() const { return kV; }
+        double getA() const { return kA; }
+
+        /**
+         * Calculates the motor command needed for a velocity and acceleration.
+         * 
+         * @param velocity the target velocity in inches per second
+         * @param acceleration the target acceleration in inches per second squared
+         * @return the motor command
+         */
+        double calculate(double velocity, double acceleration) const {
+            double sign = velocity > 0 ? 1 : (velocity < 0 ? -1 : 0);
+            return kS * sign + kV * velocity + kA * acceleration;
+        }
+};
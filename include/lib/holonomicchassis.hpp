@@ -1,14 +1,60 @@
 #pragma once
 
 #include "holonomicdrivetrain.hpp"
+#include "holonomicmixer.hpp"
 #include "chassis.hpp"
+#include "motionprofile.hpp"
 #include "odometry.hpp"
 #include "pid.hpp"
 #include "util/pose.hpp"
 #include "pros/rtos.hpp"
 
 class HolonomicChassis : public Chassis {
+    private:
+        double rotationPriority = 0.5; // Share of the motor range kept for rotation when the wheels saturate (0 - 1)
+
+        /**
+         * @brief Applies a turning speed to the drivetrain. Positive speeds increase the heading.
+         * @param speed The turning speed (-127 to 127).
+         * @param lockedSide The side of the robot to hold still, or NONE to turn in place.
+         */
+        void setTurnSpeed(double speed, SwingSide lockedSide) override;
+
+        /**
+         * @brief Applies a straight driving speed to the drivetrain. Positive speeds drive forwards.
+         * @param speed The driving speed (-127 to 127).
+         */
+        void setDriveSpeed(double speed) override;
+
+        /**
+         * @brief Converts a direction on the field to the angle driveAngle expects.
+         * @param x The x-component of the direction on the field.
+         * @param y The y-component of the direction on the field.
+         * @param heading The robot's heading in radians.
+         * @return The angle in the robot's frame in radians.
+         */
+        static double fieldToDriveAngle(double x, double y, double heading);
+
+        /**
+         * @brief The control loop behind followPath. Blocks until the path has finished.
+         * @param path The waypoints to follow.
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The pure pursuit parameters.
+         */
+        void followPathLoop(std::vector<Waypoint> path, int timeout, PurePursuitParams params);
+
+        /**
+         * @brief The control loop behind moveToPose. Blocks until the motion has finished.
+         * @param targetPose The target pose to move to.
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The motion parameters.
+         */
+        void moveToPoseLoop(Pose targetPose, int timeout, MoveToPoseParams params);
+
     public:
+        HolonomicChassis(HolonomicDrivetrain *drivetrain, Odometry *odometry, PIDController *lateralPID, PIDController *turnPID) 
+        : Chassis(drivetrain, odometry, lateralPID, turnPID) {}
+
         HolonomicChassis(HolonomicDrivetrain *drivetrain, Odometry *odometry) 
         : Chassis(drivetrain, odometry) {}
 
@@ -17,11 +63,27 @@ class HolonomicChassis : public Chassis {
 
         /**
         * @brief Drive the robot at a specific angle with translational and rotational speeds.
+        * If a wheel would need more than full speed, the wheel speeds are scaled down so the robot keeps driving in the requested direction.
+        * See setRotationPriority for how the motor range is shared between translation and rotation.
+        * 
         * @param angle The angle to drive in radians.
-        * @param transSpeed The translational speed.
-        * @param rotSpeed The rotational speed.
+        * @param transSpeed The translational speed (0 - 127).
+        * @param rotSpeed The rotational speed (-127 to 127).
         */
-        void driveAngle(double angle, int transSpeed, int rotSpeed);
+        void driveAngle(double angle, double transSpeed, double rotSpeed);
+
+        /**
+        * @brief Sets how the motor range is shared between translation and rotation when the wheels saturate.
+        * Rotation always gets whatever range translation leaves free, and is guaranteed at least this share of the range.
+        * Translation is then scaled down on all four wheels together to fit in what is left, so its direction never changes.
+        * 
+        * 0 keeps the full translation speed and only turns with the leftover range.
+        * 
+        * 1 always keeps the full rotation speed and slows translation to make room.
+        * 
+        * @param priority The share of the motor range guaranteed to rotation (0 - 1).
+        */
+        void setRotationPriority(double priority);
 
         /**
          * @brief Move the robot in field-centric mode using joystick inputs.
@@ -40,16 +102,37 @@ class HolonomicChassis : public Chassis {
         void robotCentricDrive(int leftX, int leftY, int rightX);
         
         /**
-         * @brief Move the robot to a specific position using PID control.
+         * @brief Move the robot to a specific pose, translating and rotating at the same time.
+         * The robot drives along the straight line to the target in field coordinates while turning to the target heading.
+         * If params.maxVelocity and params.maxAcceleration are set, the translation follows a trapezoidal profile with feedforward,
+         * and the heading is blended along with it so both finish together. The lateral and turn PIDs correct any error.
+         * 
          * @param targetPose The target pose to move to.
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The motion parameters.
+         * @param async If true, the motion runs in the background and this function returns immediately.
+         */
+        void moveToPose(Pose targetPose, int timeout = 0, MoveToPoseParams params = {}, bool async = false) override;
+
+        /**
+         * @brief Follow a path of waypoints using pure pursuit.
+         * The robot strafes straight at the lookahead point while the turn PID holds its starting heading.
+         * 
+         * @param path The waypoints to follow, spaced closely together (a few inches apart).
+         * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+         * @param params The pure pursuit parameters.
+         * @param async If true, the motion runs in the background and this function returns immediately.
          */
-        void moveToPose(Pose targetPose) override;
+        void followPath(std::vector<Waypoint> path, int timeout = 0, PurePursuitParams params = {}, bool async = false) override;
 
         /**
          * @brief Turn the robot to a specific angle using PID control.
-         * 0 Degrees is facing "forward" from the starting orientation.
+         * 0 Degrees is facing "forward" from the starting orientation. The robot turns whichever way is shorter.
          * 
          * @param targetAngle The target angle to turn to (in degrees).
+         * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+         * @param params The turn parameters. Set lockedSide for a swing turn.
+         * @param async If true, the turn runs in the background and this function returns immediately.
          */
-        void turnAngle(double targetAngle) override;
+        void turnAngle(double targetAngle, int timeout = 0, TurnParams params = {}, bool async = false) override;
 };
\ No newline at end of file
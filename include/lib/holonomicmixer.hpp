@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/**
+ * Mixes a holonomic drive command into the speeds of the four wheels of an X-drive or mecanum drivetrain,
+ * in the order front left, front right, back left, back right. The angle is in the robot's frame, with 0 to the right
+ * and pi / 2 forwards.
+ *
+ * If a wheel would need more than full speed, the translation is scaled down on all four wheels together,
+ * so the robot keeps driving in the requested direction. rotationPriority decides how much of the motor range rotation keeps.
+ * This has no PROS dependency, so it can be checked on a computer (see tools/mixercheck.cpp).
+ */
+class HolonomicMixer {
+    public:
+        static constexpr double MAX_SPEED = 127;
+
+        /**
+         * @brief Mixes a drive command into wheel speeds.
+         * @param angle The angle to drive in radians.
+         * @param transSpeed The translational speed (0 - 127).
+         * @param rotSpeed The rotational speed (-127 to 127).
+         * @param rotationPriority The share of the motor range guaranteed to rotation (0 - 1).
+         * @return The wheel speeds (-127 to 127).
+         */
+        static std::array<double, 4> mix(double angle, double transSpeed, double rotSpeed, double rotationPriority) {
+            double x = std::cos(angle) * transSpeed;
+            double y = std::sin(angle) * transSpeed;
+
+            // The fastest wheel's share of the translation is |x| + |y|, which is more than transSpeed at diagonal angles
+            double maxTranslation = std::abs(x) + std::abs(y);
+            if (maxTranslation + std::abs(rotSpeed) > MAX_SPEED) {
+                double rotationLimit = std::max(MAX_SPEED - maxTranslation, rotationPriority * MAX_SPEED);
+                rotSpeed = std::clamp(rotSpeed, -rotationLimit, rotationLimit);
+
+                // Scale all four wheels' translation together, which keeps its direction
+                double scale = (MAX_SPEED - std::abs(rotSpeed)) / maxTranslation;
+                if (scale < 1) {
+                    x *= scale;
+                    y *= scale;
+                }
+            }
+
+            return {y + x + rotSpeed,
+                    -y + x + rotSpeed,
+                    y - x + rotSpeed,
+                    -y - x + rotSpeed};
+        }
+};
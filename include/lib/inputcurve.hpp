@@ -0,0 +1,227 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+
+/**
+ * Class representing a joystick input curve, precomputed into a lookup table with one entry per joystick value (-127 to 127).
+ * Shaping an input is a single table lookup, so the curve's math only runs once when the curve is built.
+ *
+ * Everything is constexpr, so curves with fixed settings are built at compile time:
+ *
+ *     constexpr InputCurve driveCurve = InputCurve::exponential(8).withDeadband(5, 15);
+ *     chassis.setInputCurve(driveCurve);
+ *
+ * Curves are odd: the negative half of the table mirrors the positive half.
+ */
+class InputCurve {
+    public:
+        static constexpr int MAX_JOYSTICK = 127;
+        static constexpr size_t TABLE_SIZE = 2 * MAX_JOYSTICK + 1;
+
+    private:
+        std::array<float, TABLE_SIZE> table = {};
+
+        static constexpr double PI = 3.14159265358979323846;
+
+        /**
+         * @brief Sine usable in constant expressions (Taylor series). Accurate for |x| up to about 2.
+         */
+        static constexpr double sin(double x) {
+            double term = x;
+            double sum = x;
+            for (int i = 1; i < 20; i++) {
+                term *= -x * x / ((2 * i) * (2 * i + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        /**
+         * @brief Cosine usable in constant expressions (Taylor series). Accurate for |x| up to about 2.
+         */
+        static constexpr double cos(double x) {
+            double term = 1;
+            double sum = 1;
+            for (int i = 1; i < 20; i++) {
+                term *= -x * x / ((2 * i - 1) * (2 * i));
+                sum += term;
+            }
+            return sum;
+        }
+
+        /**
+         * @brief Exponential usable in constant expressions. The argument is halved until small, then the series result is squared back up.
+         */
+        static constexpr double exp(double x) {
+            int halvings = 0;
+            while (x > 0.5 || x < -0.5) {
+                x /= 2;
+                halvings++;
+            }
+            double term = 1;
+            double sum = 1;
+            for (int i = 1; i < 20; i++) {
+                term *= x / i;
+                sum += term;
+            }
+            for (int i = 0; i < halvings; i++) {
+                sum *= sum;
+            }
+            return sum;
+        }
+
+        /**
+         * @brief Builds a curve from a function of the normalized input (0 - 1) that returns the normalized output.
+         */
+        template <typename Function>
+        static constexpr InputCurve fromFunction(Function function) {
+            InputCurve curve;
+            for (int input = 0; input <= MAX_JOYSTICK; input++) {
+                double output = function((double)input / MAX_JOYSTICK) * MAX_JOYSTICK;
+                curve.table[MAX_JOYSTICK + input] = (float)output;
+                curve.table[MAX_JOYSTICK - input] = (float)-output;
+            }
+            return curve;
+        }
+
+    public:
+        /**
+         * @brief Construct a linear InputCurve, which leaves inputs unchanged.
+         */
+        constexpr InputCurve() {
+            for (int input = -MAX_JOYSTICK; input <= MAX_JOYSTICK; input++) {
+                table[MAX_JOYSTICK + input] = (float)input;
+            }
+        }
+
+        /**
+         * @brief Shapes a joystick input. Inputs outside -127 to 127 are clamped.
+         * @param input The joystick value.
+         * @return The shaped value.
+         */
+        constexpr double operator()(int input) const {
+            input = input < -MAX_JOYSTICK ? -MAX_JOYSTICK : (input > MAX_JOYSTICK ? MAX_JOYSTICK : input);
+            return table[MAX_JOYSTICK + input];
+        }
+
+        /**
+         * @brief Shapes a fractional input by interpolating between table entries. Inputs outside -127 to 127 are clamped.
+         * @param input The input value.
+         * @return The shaped value.
+         */
+        constexpr double sample(double input) const {
+            input = input < -MAX_JOYSTICK ? -MAX_JOYSTICK : (input > MAX_JOYSTICK ? MAX_JOYSTICK : input);
+            double index = input + MAX_JOYSTICK;
+            int lower = (int)index;
+            if (lower >= (int)TABLE_SIZE - 1) {
+                return table[TABLE_SIZE - 1];
+            }
+            double t = index - lower;
+            return table[lower] + t * (table[lower + 1] - table[lower]);
+        }
+
+        /**
+         * @brief Direct mapping.
+         */
+        static constexpr InputCurve linear() { return InputCurve(); }
+
+        /**
+         * @brief Cubic curve for finer control at low speeds.
+         */
+        static constexpr InputCurve cubic() {
+            return fromFunction([](double x) { return x * x * x; });
+        }
+
+        /**
+         * @brief Quintic curve for even finer control at low speeds.
+         */
+        static constexpr InputCurve quintic() {
+            return fromFunction([](double x) { return x * x * x * x * x; });
+        }
+
+        /**
+         * @brief Sine curve for smooth acceleration.
+         */
+        static constexpr InputCurve sine() {
+            return fromFunction([](double x) { return sin(x * PI / 2); });
+        }
+
+        /**
+         * @brief Sine squared curve for smooth acceleration and fine control at low speeds.
+         */
+        static constexpr InputCurve sineSquared() {
+            return fromFunction([](double x) { return sin(x * PI / 2) * sin(x * PI / 2); });
+        }
+
+        /**
+         * @brief Tangent for aggressive acceleration. Reaches about 1.56 times the input at full stick.
+         */
+        static constexpr InputCurve tangent() {
+            return fromFunction([](double x) { return sin(x) / cos(x); });
+        }
+
+        /**
+         * @brief Exponential tangent curve for fine control at low speeds and aggressive at high speeds. Reaches about 1.56 times the input at full stick.
+         */
+        static constexpr InputCurve xTangent() {
+            return fromFunction([](double x) { return x * sin(x) / cos(x); });
+        }
+
+        /**
+         * @brief Exponential curve with an adjustable gain. Full stick still gives full output.
+         * The output is input * (e^(-gain / 10) + e^((|input| - 127) / 10) * (1 - e^(-gain / 10))), so low inputs are scaled by about e^(-gain / 10).
+         * @param gain How strongly low inputs are reduced. 0 is linear, around 5 - 15 is typical for driving.
+         */
+        static constexpr InputCurve exponential(double gain) {
+            double lowScale = exp(-gain / 10);
+            return fromFunction([lowScale](double x) {
+                return x * (lowScale + exp((x * MAX_JOYSTICK - MAX_JOYSTICK) / 10) * (1 - lowScale));
+            });
+        }
+
+        /**
+         * @brief Piecewise-linear curve through a list of points on the positive half. The negative half is mirrored.
+         * The curve starts at (0, 0) and is flat after the last point.
+         * @param points The (input, output) points in increasing input order, on the joystick scale (0 - 127).
+         */
+        static constexpr InputCurve piecewiseLinear(std::initializer_list<std::array<double, 2>> points) {
+            return fromFunction([points](double x) {
+                double input = x * MAX_JOYSTICK;
+                double previousInput = 0;
+                double previousOutput = 0;
+                for (const std::array<double, 2> &point : points) {
+                    if (input <= point[0]) {
+                        double span = point[0] - previousInput;
+                        double t = span > 0 ? (input - previousInput) / span : 1;
+                        return (previousOutput + t * (point[1] - previousOutput)) / MAX_JOYSTICK;
+                    }
+                    previousInput = point[0];
+                    previousOutput = point[1];
+                }
+                return previousOutput / MAX_JOYSTICK;
+            });
+        }
+
+        /**
+         * @brief Adds a deadband and a minimum output to this curve.
+         * Inputs inside the deadband give 0. Past it, the rest of the stick is stretched over the whole curve,
+         * and the output is raised so the smallest input past the deadband gives minOutput, enough to overcome friction.
+         * @param deadband The largest input that gives 0 (0 - 127).
+         * @param minOutput The output just past the deadband (0 - 127).
+         * @return The new curve.
+         */
+        constexpr InputCurve withDeadband(int deadband, double minOutput) const {
+            const InputCurve &base = *this;
+            return fromFunction([&base, deadband, minOutput](double x) {
+                double input = x * MAX_JOYSTICK;
+                if (input <= deadband || deadband >= MAX_JOYSTICK) {
+                    return 0.0;
+                }
+                double stretched = (input - deadband) / (MAX_JOYSTICK - deadband) * MAX_JOYSTICK;
+                double shaped = base.sample(stretched);
+                return (minOutput + shaped * (MAX_JOYSTICK - minOutput) / MAX_JOYSTICK) / MAX_JOYSTICK;
+            });
+        }
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Timing statistics for a callback run by the LoopScheduler. All times are in microseconds.
+ */
+struct LoopStats {
+    uint32_t runs = 0;
+    uint32_t deadlineMisses = 0; // Runs that finished after the callback's next run was due
+    uint32_t lastRunTime = 0; // How long the callback took
+    uint32_t maxRunTime = 0;
+    uint32_t lastLatency = 0; // From when the run was due until the callback returned. For the drive callback, this is the input-to-command latency
+    uint32_t maxLatency = 0;
+    uint64_t totalLatency = 0;
+
+    /**
+     * @brief Get the average latency.
+     * @return The average latency in microseconds.
+     */
+    uint32_t getAverageLatency() const { return runs == 0 ? 0 : totalLatency / runs; }
+};
+
+/**
+ * Class that runs periodic callbacks at fixed rates from a single task, such as in opcontrol().
+ * The scheduler wakes up on a fixed tick with delay_until, so timing doesn't drift with how long the callbacks take.
+ *
+ * The drive callback always runs first on every tick it is due, so mechanism code can only delay it by overrunning a whole tick.
+ * Each callback's latency and deadline misses are measured, which shows when other code is stealing time from the drive loop.
+ *
+ *     LoopScheduler scheduler(10);
+ *     scheduler.setDrive([] { chassis.arcade(master.get_analog(ANALOG_LEFT_Y), master.get_analog(ANALOG_RIGHT_X)); }, 10);
+ *     int intakeId = scheduler.add([] { updateIntake(); }, 20);
+ *     scheduler.run();
+ */
+class LoopScheduler {
+    public:
+        static constexpr size_t MAX_CALLBACKS = 8;
+        static constexpr int DRIVE = 0; // Id of the drive callback
+
+    private:
+        struct Callback {
+            std::function<void()> function;
+            uint32_t period = 0; // in milliseconds, 0 if the slot is unused
+            uint32_t nextRun = 0; // in milliseconds
+            LoopStats stats;
+        };
+
+        // The drive callback is always in the first slot, so it runs first
+        std::array<Callback, MAX_CALLBACKS> callbacks;
+        uint32_t tickPeriod; // in milliseconds
+        bool running = false;
+
+        /**
+         * @brief Runs a callback if it is due and records its timing.
+         * @param callback The callback.
+         * @param now The start of the current tick in milliseconds.
+         */
+        void runCallback(Callback &callback, uint32_t now);
+
+    public:
+        /**
+         * @brief Construct a new LoopScheduler object.
+         * @param tickPeriod How often the scheduler wakes up in milliseconds. Callback periods are rounded up to a multiple of it.
+         */
+        LoopScheduler(uint32_t tickPeriod = 10) : tickPeriod(tickPeriod == 0 ? 1 : tickPeriod) {}
+
+        /**
+         * @brief Sets the drive callback, which reads the controller and commands the drivetrain. It runs before every other callback.
+         * @param function The callback.
+         * @param period How often it runs in milliseconds.
+         */
+        void setDrive(std::function<void()> function, uint32_t period);
+
+        /**
+         * @brief Adds a periodic callback, such as a mechanism's control code.
+         * @param function The callback.
+         * @param period How often it runs in milliseconds.
+         * @return The callback's id for getStats, or -1 if MAX_CALLBACKS callbacks have already been added.
+         */
+        int add(std::function<void()> function, uint32_t period);
+
+        /**
+         * @brief Runs the callbacks until stop() is called from one of them. Blocks the calling task.
+         */
+        void run();
+
+        /**
+         * @brief Makes run() return after the current tick.
+         */
+        void stop() { running = false; }
+
+        /**
+         * @brief Get the timing statistics of a callback.
+         * @param id The callback's id, or DRIVE for the drive callback.
+         * @return The statistics.
+         */
+        LoopStats getStats(int id) const;
+
+        /**
+         * @brief Resets the timing statistics of every callback.
+         */
+        void resetStats();
+};
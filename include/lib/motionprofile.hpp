@@ -0,0 +1,270 @@
+#pragma once
+
+#include <array>
+
+/**
+ * The state of a motion profile at a point in time.
+ */
+struct ProfileState {
+    double position = 0; // in inches
+    double velocity = 0; // in inches per second
+    double acceleration = 0; // in inches per second squared
+};
+
+/**
+ * Class representing a one-dimensional motion profile.
+ * Trapezoidal profiles limit velocity and acceleration, S-curve profiles additionally limit jerk for smoother starts and stops.
+ * S-curve profiles run from rest to rest. Trapezoidal profiles can start and end moving, so chained motions don't have to stop in between.
+ *
+ * The profile is stored as up to 7 constant-jerk segments, so sampling it at any time is O(1).
+ * Everything is constexpr, so profiles for fixed autonomous moves can be built at compile time:
+ *
+ *     constexpr MotionProfile profile = MotionProfile::sCurve(48, 60, 120, 600);
+ *     static_assert(profile.getDuration() > 0);
+ *
+ * Profiles for dynamic targets are built the same way at runtime.
+ * The sampled position and velocity are meant to be used as the PID setpoint and the feedforward input.
+ */
+class MotionProfile {
+    private:
+        static constexpr int MAX_SEGMENTS = 7;
+
+        // Each segment runs for a duration with a constant jerk, starting from the state at its start time
+        std::array<double, MAX_SEGMENTS> durations = {};
+        std::array<double, MAX_SEGMENTS> jerks = {};
+        std::array<double, MAX_SEGMENTS> startTimes = {};
+        std::array<ProfileState, MAX_SEGMENTS> startStates = {};
+
+        double duration = 0;
+        double direction = 1;
+        ProfileState endState;
+
+        /**
+         * @brief Square root usable in constant expressions (Newton's method).
+         */
+        static constexpr double sqrt(double x) {
+            if (x <= 0) {
+                return 0;
+            }
+            double guess = x < 1 ? 1 : x;
+            for (int i = 0; i < 100; i++) {
+                double next = 0.5 * (guess + x / guess);
+                if (next == guess) {
+                    break;
+                }
+                guess = next;
+            }
+            return guess;
+        }
+
+        /**
+         * @brief Cube root usable in constant expressions (Newton's method).
+         */
+        static constexpr double cbrt(double x) {
+            if (x <= 0) {
+                return 0;
+            }
+            double guess = x < 1 ? 1 : x;
+            for (int i = 0; i < 200; i++) {
+                double next = (2 * guess + x / (guess * guess)) / 3;
+                if (next == guess) {
+                    break;
+                }
+                guess = next;
+            }
+            return guess;
+        }
+
+        /**
+         * @brief Advances a state by a time with a constant jerk.
+         */
+        static constexpr ProfileState integrate(ProfileState state, double jerk, double t) {
+            ProfileState next;
+            next.position = state.position + state.velocity * t + state.acceleration * t * t / 2 + jerk * t * t * t / 6;
+            next.velocity = state.velocity + state.acceleration * t + jerk * t * t / 2;
+            next.acceleration = state.acceleration + jerk * t;
+            return next;
+        }
+
+        /**
+         * @brief Builds the profile from the duration, starting acceleration, and jerk of each segment. Zero length segments are allowed.
+         */
+        constexpr MotionProfile(double direction, std::array<double, MAX_SEGMENTS> durations, std::array<double, MAX_SEGMENTS> accelerations, std::array<double, MAX_SEGMENTS> jerks, double startVel = 0)
+        : durations(durations), jerks(jerks), direction(direction) {
+            ProfileState state;
+            state.velocity = startVel;
+            double time = 0;
+            for (int i = 0; i < MAX_SEGMENTS; i++) {
+                state.acceleration = accelerations[i];
+                startTimes[i] = time;
+                startStates[i] = state;
+                state = integrate(state, jerks[i], durations[i]);
+                time += durations[i];
+            }
+            duration = time;
+            endState = state;
+        }
+
+    public:
+        /**
+         * Default constructor for the motion profile.
+         * Creates an empty profile that stays at position 0.
+         */
+        constexpr MotionProfile() {}
+
+        /**
+         * Creates a trapezoidal profile that accelerates at maxAccel up to maxVel, cruises, then decelerates to endVel.
+         * If the distance is too short to reach maxVel, the profile becomes triangular.
+         * If the distance is too short to reach endVel at all, the profile accelerates or decelerates the whole way and ends as close to endVel as it can.
+         *
+         * @param distance the distance to travel in inches, negative to travel backwards
+         * @param maxVel the maximum velocity in inches per second
+         * @param maxAccel the maximum acceleration in inches per second squared
+         * @param startVel the velocity at the start in inches per second, in the direction of travel (0 - maxVel)
+         * @param endVel the velocity at the end in inches per second, in the direction of travel (0 - maxVel)
+         * @return the motion profile
+         */
+        static constexpr MotionProfile trapezoidal(double distance, double maxVel, double maxAccel, double startVel = 0, double endVel = 0) {
+            double direction = distance < 0 ? -1 : 1;
+            distance *= direction;
+            if (distance == 0 || maxVel <= 0 || maxAccel <= 0) {
+                return MotionProfile();
+            }
+            startVel = startVel < 0 ? 0 : (startVel > maxVel ? maxVel : startVel);
+            endVel = endVel < 0 ? 0 : (endVel > maxVel ? maxVel : endVel);
+
+            // Keep the end velocity reachable from the start velocity within the distance
+            double slowestEnd = sqrt(startVel * startVel - 2 * maxAccel * distance);
+            double fastestEnd = sqrt(startVel * startVel + 2 * maxAccel * distance);
+            endVel = endVel < slowestEnd ? slowestEnd : (endVel > fastestEnd ? fastestEnd : endVel);
+
+            // Lower the peak velocity if there isn't room to reach maxVel and slow down again
+            double peakVel = maxVel;
+            if ((2 * peakVel * peakVel - startVel * startVel - endVel * endVel) / (2 * maxAccel) > distance) {
+                peakVel = sqrt((2 * maxAccel * distance + startVel * startVel + endVel * endVel) / 2);
+            }
+
+            double accelTime = (peakVel - startVel) / maxAccel;
+            double decelTime = (peakVel - endVel) / maxAccel;
+            double rampDistance = (2 * peakVel * peakVel - startVel * startVel - endVel * endVel) / (2 * maxAccel);
+            double cruiseTime = peakVel > 0 ? (distance - rampDistance) / peakVel : 0;
+            if (cruiseTime < 0) {
+                cruiseTime = 0;
+            }
+
+            return MotionProfile(direction,
+                {accelTime, cruiseTime, decelTime, 0, 0, 0, 0},
+                {maxAccel, 0, -maxAccel, 0, 0, 0, 0},
+                {0, 0, 0, 0, 0, 0, 0},
+                startVel);
+        }
+
+        /**
+         * Creates a jerk-limited S-curve profile.
+         * The acceleration ramps up at maxJerk instead of jumping, which reduces wheel slip and keeps the robot from rocking.
+         * Peak acceleration and velocity are lowered automatically when the distance is too short to reach them.
+         *
+         * @param distance the distance to travel in inches, negative to travel backwards
+         * @param maxVel the maximum velocity in inches per second
+         * @param maxAccel the maximum acceleration in inches per second squared
+         * @param maxJerk the maximum jerk in inches per second cubed
+         * @return the motion profile
+         */
+        static constexpr MotionProfile sCurve(double distance, double maxVel, double maxAccel, double maxJerk) {
+            double direction = distance < 0 ? -1 : 1;
+            distance *= direction;
+            if (distance == 0 || maxVel <= 0 || maxAccel <= 0 || maxJerk <= 0) {
+                return MotionProfile();
+            }
+
+            // Velocity gained while ramping acceleration up to maxAccel and back down
+            double peakVel = maxVel;
+            double peakAccel = maxAccel;
+            if (peakVel * maxJerk < maxAccel * maxAccel) {
+                peakAccel = sqrt(peakVel * maxJerk);
+            }
+
+            // Distance needed to reach the peak velocity and stop again
+            auto stoppingDistance = [](double vel, double accel, double jerk) {
+                return vel * (vel / accel + accel / jerk);
+            };
+
+            if (stoppingDistance(peakVel, peakAccel, maxJerk) > distance) {
+                // Solve vel^2 / accel + vel * accel / jerk = distance for vel with full acceleration
+                double ratio = maxAccel / maxJerk;
+                peakVel = maxAccel / 2 * (-ratio + sqrt(ratio * ratio + 4 * distance / maxAccel));
+                peakAccel = maxAccel;
+
+                // If maxAccel can't be reached either, the profile never holds a constant acceleration
+                if (peakVel * maxJerk < maxAccel * maxAccel) {
+                    peakVel = cbrt(distance * distance * maxJerk / 4);
+                    peakAccel = sqrt(peakVel * maxJerk);
+                }
+            }
+
+            double jerkTime = peakAccel / maxJerk;
+            double accelTime = peakVel / peakAccel - jerkTime;
+            if (accelTime < 0) {
+                accelTime = 0;
+            }
+            double accelDistance = peakVel * (2 * jerkTime + accelTime) / 2;
+            double cruiseTime = (distance - 2 * accelDistance) / peakVel;
+            if (cruiseTime < 0) {
+                cruiseTime = 0;
+            }
+
+            return MotionProfile(direction,
+                {jerkTime, accelTime, jerkTime, cruiseTime, jerkTime, accelTime, jerkTime},
+                {0, peakAccel, peakAccel, 0, 0, -peakAccel, -peakAccel},
+                {maxJerk, 0, -maxJerk, 0, -maxJerk, 0, maxJerk});
+        }
+
+        /**
+         * Samples the profile at a time. Times before the start or after the end are clamped.
+         *
+         * @param t the time since the start of the profile in seconds
+         * @return the position, velocity, and acceleration at that time
+         */
+        constexpr ProfileState sample(double t) const {
+            ProfileState state;
+            if (t >= duration) {
+                state = endState;
+                state.acceleration = 0;
+            } else {
+                if (t < 0) {
+                    t = 0;
+                }
+                int segment = 0;
+                while (segment + 1 < MAX_SEGMENTS && t >= startTimes[segment + 1]) {
+                    segment++;
+                }
+                state = integrate(startStates[segment], jerks[segment], t - startTimes[segment]);
+            }
+
+            state.position *= direction;
+            state.velocity *= direction;
+            state.acceleration *= direction;
+            return state;
+        }
+
+        /**
+         * Gets the total duration of the profile.
+         *
+         * @return the duration in seconds
+         */
+        constexpr double getDuration() const { return duration; }
+
+        /**
+         * Gets the velocity at the end of the profile.
+         *
+         * @return the velocity in inches per second, negative if the profile travels backwards
+         */
+        constexpr double getEndVelocity() const { return endState.velocity * direction; }
+
+        /**
+         * Gets the total distance of the profile.
+         *
+         * @return the distance in inches, negative if the profile travels backwards
+         */
+        constexpr double getDistance() const { return endState.position * direction; }
+};
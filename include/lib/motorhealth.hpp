@@ -0,0 +1,157 @@
+#pragma once
+
+#include "blackbox.hpp"
+#include "motorsampler.hpp"
+#include "pros/misc.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Thresholds of the motor health checks. Ratios compare a motor with the average of the other motors in its group.
+ */
+struct HealthParams {
+    double smoothing = 0.2; // Weight of each new reading in the moving averages (0 - 1)
+    uint32_t warmupSamples = 10; // Readings a motor needs before it is compared with its group
+    double currentDeviations = 3; // How many standard deviations above its group a motor's current must be to flag it
+    double minCurrentExcess = 600; // A motor must draw at least this much more current than its group to flag it (milliamps)
+    double stallRatio = 0.3; // A motor moving slower than this fraction of its group is stalled
+    double minVelocity = 30; // Stalls are only checked while the group moves faster than this (RPM)
+    double powerLossRatio = 0.3; // A motor applying less than this fraction of its group's voltage is losing power
+    double minVoltage = 3000; // Power loss is only checked while the group applies more than this (millivolts)
+    uint32_t clearTime = 500; // How long a fault's condition must be gone before it clears (milliseconds)
+    uint32_t rumbleInterval = 2000; // The least time between rumbles (milliseconds), 0 disables rumbling
+};
+
+/**
+ * Class that watches each motor's readings for signs of a failing motor or a loose port, such as intermittent power loss.
+ *
+ * Motors in the same motor group are driven together, so they should move, draw current and apply voltage alike.
+ * For every motor, the monitor keeps an exponentially weighted moving average of its current draw, velocity and voltage,
+ * and a moving variance of its current draw. Each motor is compared with the average of the other motors in its group:
+ *  - DISCONNECTED: the motor couldn't be read.
+ *  - STALLED: the motor moves much slower than the rest of its group.
+ *  - OVERCURRENT: the motor draws much more current than the rest of its group, by both a number of standard deviations and an absolute amount.
+ *  - POWER_LOSS: the motor applies much less voltage than the rest of its group.
+ * Groups with a single motor are only checked for disconnects.
+ *
+ * New faults rumble the controller, and every change of a motor's faults is logged to the black box.
+ * Readings come from a MotorSampler, so updates make no device reads. Call update() at the sampler's period, such as from a LoopScheduler:
+ *
+ *     MotorHealthMonitor health(&sampler);
+ *     health.setController(&master);
+ *     health.setBlackBox(&blackBox);
+ *     scheduler.add([] { health.update(); }, 20);
+ */
+class MotorHealthMonitor {
+    public:
+        static constexpr uint8_t DISCONNECTED = 0x01;
+        static constexpr uint8_t STALLED = 0x02;
+        static constexpr uint8_t OVERCURRENT = 0x04;
+        static constexpr uint8_t POWER_LOSS = 0x08;
+        static constexpr size_t FAULT_COUNT = 4;
+
+    private:
+        struct MotorStats {
+            uint32_t samples = 0; // Readings averaged since the motor was last connected
+            double current = 0; // Averages in milliamps, RPM and millivolts
+            double currentVariance = 0;
+            double velocity = 0;
+            double voltage = 0;
+            std::array<uint32_t, FAULT_COUNT> lastSeen = {}; // When each fault's condition last held, from pros::millis()
+        };
+
+        MotorSampler *sampler;
+        HealthParams params;
+        pros::Controller *controller = nullptr;
+        BlackBox *blackBox = nullptr;
+        uint8_t eventId = 0;
+
+        std::array<MotorStats, MotorRecord::MAX_MOTORS> stats;
+        std::array<uint8_t, MotorRecord::MAX_MOTORS> faults = {}; // Faults currently raised
+        std::array<uint8_t, MotorRecord::MAX_MOTORS> faultHistory = {}; // Every fault raised since the last clearFaults()
+        std::array<uint32_t, MotorRecord::MAX_MOTORS> disconnectCounts = {};
+        size_t motorCount = 0;
+        uint32_t lastTimestamp = 0;
+        uint32_t lastRumble = 0;
+        bool rumbled = false;
+
+        /**
+         * @brief Adds a reading to a motor's moving averages.
+         * @param motor The motor's stats.
+         * @param sample The reading.
+         */
+        void updateStats(MotorStats &motor, const MotorSample &sample);
+
+        /**
+         * @brief Raises, keeps or clears a motor's faults, and reports any change.
+         * @param motor The motor's index in the sampler's records.
+         * @param group The motor's group.
+         * @param detected The faults whose conditions hold in this reading.
+         * @param time When the reading was taken, from pros::millis().
+         */
+        void setFaults(size_t motor, size_t group, uint8_t detected, uint32_t time);
+
+    public:
+        /**
+         * @brief Construct a new MotorHealthMonitor object.
+         * @param sampler The sampler reading the motors. It must be started separately.
+         * @param params The health check thresholds.
+         */
+        MotorHealthMonitor(MotorSampler *sampler, HealthParams params = {}) : sampler(sampler), params(params) {}
+
+        /**
+         * @brief Sets the controller that rumbles when a new fault is raised.
+         * @param controller The controller, or nullptr to stop rumbling.
+         */
+        void setController(pros::Controller *controller) { this->controller = controller; }
+
+        /**
+         * @brief Sets the black box that fault changes are logged to.
+         * Each change is an event with the motor's index, its group, its faults, and its average current, velocity and voltage.
+         * @param blackBox The black box, or nullptr to stop logging.
+         * @param eventId The id of the logged events.
+         */
+        void setBlackBox(BlackBox *blackBox, uint8_t eventId = 0) {
+            this->blackBox = blackBox;
+            this->eventId = eventId;
+        }
+
+        /**
+         * @brief Checks the latest sample, if there is a new one.
+         */
+        void update();
+
+        /**
+         * @brief Get a motor's current faults.
+         * @param motor The motor's index in the sampler's records.
+         * @return The faults, as a combination of DISCONNECTED, STALLED, OVERCURRENT and POWER_LOSS.
+         */
+        uint8_t getFaults(size_t motor) const { return motor < motorCount ? faults[motor] : 0; }
+
+        /**
+         * @brief Get every fault a motor has had since the last clearFaults(), including ones that have since cleared.
+         * @param motor The motor's index in the sampler's records.
+         * @return The faults, as a combination of DISCONNECTED, STALLED, OVERCURRENT and POWER_LOSS.
+         */
+        uint8_t getFaultHistory(size_t motor) const { return motor < motorCount ? faultHistory[motor] : 0; }
+
+        /**
+         * @brief Get how many times a motor has disconnected since the last clearFaults(). A loose port disconnects repeatedly.
+         * Disconnects closer together than clearTime count as one.
+         * @param motor The motor's index in the sampler's records.
+         * @return The number of disconnects.
+         */
+        uint32_t getDisconnectCount(size_t motor) const { return motor < motorCount ? disconnectCounts[motor] : 0; }
+
+        /**
+         * @brief Checks if any motor has a fault right now.
+         * @return True if any motor has a fault.
+         */
+        bool hasFaults() const;
+
+        /**
+         * @brief Clears the fault history and disconnect counts. Faults whose conditions still hold stay raised.
+         */
+        void clearFaults();
+};
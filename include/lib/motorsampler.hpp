@@ -0,0 +1,147 @@
+#pragma once
+
+#include "drivetrain.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * One motor's readings, packed into 8 bytes.
+ */
+struct MotorSample {
+    int16_t velocity; // in tenths of an RPM
+    int16_t currentDraw; // in milliamps
+    int16_t voltage; // in millivolts
+    uint8_t temperature; // in degrees Celsius
+    uint8_t flags; // Bit 0 is set if the motor couldn't be read (unplugged). Bits 4 - 7 are the index of its motor group (see MotorSampler)
+
+    static constexpr uint8_t DISCONNECTED = 0x01;
+
+    double getVelocity() const { return velocity / 10.0; }
+    bool isConnected() const { return (flags & DISCONNECTED) == 0; }
+    size_t getGroup() const { return flags >> 4; }
+};
+
+/**
+ * The readings of every sampled motor taken in one pass of the sampler.
+ */
+struct MotorRecord {
+    static constexpr size_t MAX_MOTORS = 20;
+
+    uint32_t timestamp; // When the pass started, from pros::millis()
+    uint32_t motorCount;
+    std::array<MotorSample, MAX_MOTORS> motors; // In order of motor group index, then by index within each group
+};
+
+/**
+ * Class that reads every drivetrain motor from a low-priority background task, so control code never waits on device reads.
+ * Mechanism motor groups can be added to be read along with the drivetrain.
+ * The drivetrain's groups keep their indexes from getMotors(), and added groups are numbered from Drivetrain::MAX_MOTOR_GROUPS.
+ *
+ * Records are written into a ring buffer by the sampler task and can be read from any number of other tasks without locks.
+ * Each slot has a sequence number that is odd while the sampler is writing it. Readers copy a slot and check that
+ * the sequence didn't change, retrying if the sampler overwrote it in the meantime, so a reader never sees a half-written record
+ * and never blocks the sampler.
+ *
+ *     MotorSampler sampler(&drivetrain, 20);
+ *     sampler.start();
+ *     MotorRecord latest;
+ *     if (sampler.getLatest(latest)) { ... }
+ */
+class MotorSampler {
+    public:
+        static constexpr size_t HISTORY_SIZE = 64; // Number of records kept
+        static constexpr size_t MAX_EXTRA_GROUPS = 8;
+
+    private:
+        struct Slot {
+            std::atomic<uint32_t> sequence{0};
+            uint32_t index = 0; // Which record this slot holds, counting from the first record written
+            MotorRecord record;
+        };
+
+        Drivetrain *drivetrain;
+        std::array<pros::MotorGroup*, MAX_EXTRA_GROUPS> extraGroups = {};
+        size_t extraGroupCount = 0;
+        uint32_t period; // in milliseconds
+        std::array<Slot, HISTORY_SIZE> slots;
+        std::atomic<uint32_t> recordCount{0}; // Records written so far. Only the sampler task writes it
+        std::atomic<bool> running{false};
+        std::atomic<bool> stopped{true}; // Set by the sampler task once it has exited
+
+        /**
+         * @brief Reads every motor into a record.
+         * @param record The record to fill.
+         */
+        void sample(MotorRecord &record);
+
+        /**
+         * @brief Writes a record into the next slot.
+         * @param record The record to write.
+         */
+        void publish(const MotorRecord &record);
+
+        /**
+         * @brief Copies a record out of the ring buffer.
+         * @param index The record to copy, counting from the first record written.
+         * @param record Where to copy the record.
+         * @return False if the record has already been overwritten.
+         */
+        bool read(uint32_t index, MotorRecord &record) const;
+
+    public:
+        /**
+         * @brief Construct a new MotorSampler object.
+         * @param drivetrain The drivetrain whose motors are read.
+         * @param period How often the motors are read in milliseconds.
+         */
+        MotorSampler(Drivetrain *drivetrain, uint32_t period = 20) : drivetrain(drivetrain), period(period == 0 ? 1 : period) {}
+
+        /**
+         * @brief Adds a mechanism's motor group to be read along with the drivetrain. Add groups before starting the sampler.
+         * @param motors The motor group.
+         * @return The group's index in the records, or -1 if MAX_EXTRA_GROUPS groups have already been added.
+         */
+        int addMotors(pros::MotorGroup *motors);
+
+        /**
+         * @brief Starts the sampler task if it is not already running.
+         * If the sampler was just stopped, this waits for the previous task to finish its last pass, so two tasks never publish at once.
+         * @param priority The task priority. Keep it below the control tasks.
+         */
+        void start(uint32_t priority = TASK_PRIORITY_MIN + 1);
+
+        /**
+         * @brief Stops the sampler task after its current pass.
+         */
+        void stop() { running = false; }
+
+        /**
+         * @brief Sets how often the motors are read.
+         * @param period The new period in milliseconds.
+         */
+        void setPeriod(uint32_t period) { this->period = period == 0 ? 1 : period; }
+
+        /**
+         * @brief Get the most recent record, without any device calls.
+         * @param record Where to copy the record.
+         * @return False if nothing has been sampled yet.
+         */
+        bool getLatest(MotorRecord &record) const;
+
+        /**
+         * @brief Get the most recent records, without any device calls.
+         * @param records Where to copy the records, oldest first.
+         * @param count The most records to copy. At most HISTORY_SIZE - 1 are available.
+         * @return The number of records copied.
+         */
+        size_t getHistory(MotorRecord *records, size_t count) const;
+
+        /**
+         * @brief Get the number of records written since the sampler started.
+         * @return The number of records.
+         */
+        uint32_t getRecordCount() const { return recordCount.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Class representing an occupancy grid of the field for path planning.
+ * The field is split into square cells, and each cell is stored as a single bit, so the whole field fits in well under 1 KB per layer.
+ *
+ * Obstacles are inflated by the robot's radius when they are added, so the planner can treat the robot as a single point.
+ * There are two layers: static structures that never move, and dynamic obstacles from sensors that can be cleared every frame.
+ * Every cell that switches between free and occupied is recorded, so an incremental planner only has to repair the changed cells.
+ *
+ * Coordinates are in inches with the same axes as the tracked pose. By default the grid is centered on (0, 0),
+ * so the robot's pose should be set relative to the center of the field when planning.
+ */
+class OccupancyGrid {
+    public:
+        static constexpr int WIDTH = 72; // in cells
+        static constexpr int HEIGHT = 72; // in cells
+        static constexpr size_t CELLS = WIDTH * HEIGHT;
+        static constexpr size_t MAX_CHANGES = 1024;
+        static constexpr uint16_t NO_CELL = 0xFFFF;
+
+    private:
+        static constexpr size_t WORDS = (CELLS + 63) / 64;
+
+        std::array<uint64_t, WORDS> staticCells = {};
+        std::array<uint64_t, WORDS> dynamicCells = {};
+
+        double resolution; // in inches per cell
+        double originX; // x coordinate of the grid's lower left corner (in inches)
+        double originY; // y coordinate of the grid's lower left corner (in inches)
+        double robotRadius; // in inches
+
+        // Cells that have switched between free and occupied since the changes were last cleared
+        std::array<uint16_t, MAX_CHANGES> changes = {};
+        size_t changeCount = 0;
+        bool changesOverflowed = false;
+
+        static bool getBit(const std::array<uint64_t, WORDS> &bits, size_t cell) { return (bits[cell / 64] >> (cell % 64)) & 1; }
+
+        /**
+         * @brief Sets a cell in a layer, recording the change if the cell switched between free and occupied.
+         */
+        void setCell(std::array<uint64_t, WORDS> &layer, size_t cell, bool value);
+
+        /**
+         * @brief Marks every cell within the rectangle grown by the robot's radius in a layer.
+         */
+        void fillRectangle(std::array<uint64_t, WORDS> &layer, double minX, double minY, double maxX, double maxY);
+
+        /**
+         * @brief Marks every cell within the circle grown by the robot's radius in a layer.
+         */
+        void fillCircle(std::array<uint64_t, WORDS> &layer, double x, double y, double radius);
+
+    public:
+        /**
+         * @brief Construct a new OccupancyGrid object covering a 144 x 144 inch field. The field walls are added automatically.
+         * @param robotRadius The radius of a circle around the robot's tracking center that covers the whole robot (in inches).
+         * @param originX The x coordinate of the field's lower left corner (in inches).
+         * @param originY The y coordinate of the field's lower left corner (in inches).
+         */
+        OccupancyGrid(double robotRadius, double originX = -72, double originY = -72);
+
+        /**
+         * @brief Get the size of a cell.
+         * @return The width of a cell in inches.
+         */
+        double getResolution() const { return resolution; }
+
+        /**
+         * @brief Converts a position to the cell containing it.
+         * @param x The x coordinate (in inches).
+         * @param y The y coordinate (in inches).
+         * @return The cell index, or NO_CELL if the position is outside the grid.
+         */
+        uint16_t cellAt(double x, double y) const;
+
+        /**
+         * @brief Get the x coordinate of the center of a cell.
+         * @param cell The cell index.
+         * @return The x coordinate in inches.
+         */
+        double cellX(uint16_t cell) const { return originX + (cell % WIDTH + 0.5) * resolution; }
+
+        /**
+         * @brief Get the y coordinate of the center of a cell.
+         * @param cell The cell index.
+         * @return The y coordinate in inches.
+         */
+        double cellY(uint16_t cell) const { return originY + (cell / WIDTH + 0.5) * resolution; }
+
+        /**
+         * @brief Returns whether the robot's center can't be placed in a cell.
+         * @param cell The cell index.
+         * @return True if the cell is occupied by a static or dynamic obstacle.
+         */
+        bool isOccupied(uint16_t cell) const { return getBit(staticCells, cell) || getBit(dynamicCells, cell); }
+
+        /**
+         * @brief Returns whether the robot's center can't be placed at a position. Positions outside the grid are occupied.
+         * @param x The x coordinate (in inches).
+         * @param y The y coordinate (in inches).
+         * @return True if the position is occupied.
+         */
+        bool isOccupied(double x, double y) const;
+
+        /**
+         * @brief Returns whether the robot can drive in a straight line between two points without entering an occupied cell.
+         * @param x1 The x coordinate of the first point (in inches).
+         * @param y1 The y coordinate of the first point (in inches).
+         * @param x2 The x coordinate of the second point (in inches).
+         * @param y2 The y coordinate of the second point (in inches).
+         * @return True if the line is clear.
+         */
+        bool isLineClear(double x1, double y1, double x2, double y2) const;
+
+        /**
+         * @brief Adds a rectangular field structure that never moves.
+         * @param minX The left edge (in inches).
+         * @param minY The bottom edge (in inches).
+         * @param maxX The right edge (in inches).
+         * @param maxY The top edge (in inches).
+         */
+        void addStaticRectangle(double minX, double minY, double maxX, double maxY);
+
+        /**
+         * @brief Adds a circular field structure that never moves.
+         * @param x The x coordinate of the center (in inches).
+         * @param y The y coordinate of the center (in inches).
+         * @param radius The radius (in inches).
+         */
+        void addStaticCircle(double x, double y, double radius);
+
+        /**
+         * @brief Adds the structures of the Push Back field: the center goals, the long goals, and the match loaders.
+         * The positions are approximate and assume the grid is centered on the field, with the alliance walls along x = +-72.
+         * Check them against your field and add margins with addStaticRectangle if needed.
+         */
+        void addPushBackField();
+
+        /**
+         * @brief Adds an obstacle seen by a sensor, such as another robot.
+         * @param x The x coordinate of the center (in inches).
+         * @param y The y coordinate of the center (in inches).
+         * @param radius The radius (in inches).
+         */
+        void addObstacle(double x, double y, double radius);
+
+        /**
+         * @brief Removes every obstacle added with addObstacle. Static structures are kept.
+         */
+        void clearObstacles();
+
+        /**
+         * @brief Get the cells that switched between free and occupied since clearChanges was last called.
+         * @param count Set to the number of changed cells.
+         * @return The changed cells, or nullptr if more than MAX_CHANGES cells changed.
+         */
+        const uint16_t *getChanges(size_t &count) const;
+
+        /**
+         * @brief Forgets the recorded changes.
+         */
+        void clearChanges();
+};
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "occupancygrid.hpp"
+#include "purepursuit.hpp"
+
+/**
+ * The priority of a cell in the planner's open list. Keys are compared by first, then by second.
+ */
+struct PlannerKey {
+    float first = 0;
+    float second = 0;
+
+    bool operator<(const PlannerKey &other) const {
+        return first < other.first || (first == other.first && second < other.second);
+    }
+};
+
+/**
+ * Binary min-heap of grid cells with a fixed capacity of one entry per cell.
+ * Each cell's position in the heap is stored, so a cell's key can be changed or the cell removed in O(log n) without searching.
+ * No memory is allocated after construction.
+ */
+class CellHeap {
+    private:
+        static constexpr uint16_t NOT_IN_HEAP = 0xFFFF;
+
+        std::array<uint16_t, OccupancyGrid::CELLS> heap; // Cells in heap order
+        std::array<uint16_t, OccupancyGrid::CELLS> positions; // Index of each cell in heap, or NOT_IN_HEAP
+        std::array<PlannerKey, OccupancyGrid::CELLS> keys;
+        size_t size = 0;
+
+        void swap(size_t a, size_t b);
+        void siftUp(size_t index);
+        void siftDown(size_t index);
+
+    public:
+        CellHeap() { positions.fill(NOT_IN_HEAP); }
+
+        bool empty() const { return size == 0; }
+        bool contains(uint16_t cell) const { return positions[cell] != NOT_IN_HEAP; }
+        uint16_t top() const { return heap[0]; }
+        PlannerKey topKey() const { return keys[heap[0]]; }
+
+        /**
+         * @brief Removes every cell. O(n) in the number of cells in the heap.
+         */
+        void clear();
+
+        /**
+         * @brief Inserts a cell, or changes its key if it is already in the heap.
+         * @param cell The cell index.
+         * @param key The cell's priority, lowest first.
+         */
+        void push(uint16_t cell, PlannerKey key);
+
+        /**
+         * @brief Removes a cell if it is in the heap.
+         * @param cell The cell index.
+         */
+        void remove(uint16_t cell);
+
+        /**
+         * @brief Removes and returns the cell with the lowest key.
+         * @return The cell index.
+         */
+        uint16_t pop();
+};
+
+/**
+ * Class that plans obstacle-free paths across an occupancy grid.
+ * Paths are found with A* over the 8-connected grid, then smoothed by cutting corners wherever the straight line is clear,
+ * and returned as evenly spaced waypoints for the pure pursuit follower.
+ *
+ * For a goal that stays the same while obstacles move, use the incremental mode (D* Lite):
+ * call startIncremental() once, then after updating the grid's obstacles call replan() with the robot's current position.
+ * Only the cells affected by the changes are searched again, instead of planning from scratch. A change that blocks the current
+ * path makes most of the search stale, so replan() searches from scratch then, which is no slower than A*.
+ *
+ * All search memory, including the scratch space for building paths, is allocated when the planner is constructed.
+ * The only allocation per query is the returned path (plus the corner list, if a path has more than MAX_CORNERS corners).
+ * The planner is large, so create it once as a global. tools/plannerbench.cpp times typical queries on the Push Back field.
+ */
+class PathPlanner {
+    public:
+        static constexpr size_t MAX_CORNERS = 64; // Corners reserved for smoothing a path
+
+    private:
+        OccupancyGrid *grid;
+        CellHeap open;
+
+        // g is the cost to reach each cell (A*) or to reach the goal from each cell (D* Lite), rhs is the one-step lookahead of g
+        std::array<float, OccupancyGrid::CELLS> g;
+        std::array<float, OccupancyGrid::CELLS> rhs;
+        std::array<uint16_t, OccupancyGrid::CELLS> parents;
+
+        // The grid as of the start of the search or the last repair. Moves are checked against this copy, which is quicker than
+        // the grid's bits, and in incremental mode it shows which recorded changes have since been undone
+        std::array<bool, OccupancyGrid::CELLS> occupied;
+
+        // Incremental mode state
+        std::array<bool, OccupancyGrid::CELLS> pending; // Cells queued for an update during a repair
+        std::vector<uint16_t> updates; // The queued cells, in order
+        uint16_t incrementalStart = OccupancyGrid::NO_CELL;
+        uint16_t incrementalGoal = OccupancyGrid::NO_CELL;
+        float keyModifier = 0;
+        double goalX = 0;
+        double goalY = 0;
+
+        // Scratch space for building paths, reused by every query
+        std::vector<uint16_t> chain;
+        std::vector<Waypoint> corners;
+
+        /**
+         * @brief Octile distance between two cells, in cells. Never overestimates the cost on an 8-connected grid.
+         */
+        float heuristic(uint16_t a, uint16_t b) const;
+
+        /**
+         * @brief Get the cells next to a cell, including diagonally, and the costs of moving between the cell and each of them.
+         * Moves into an occupied cell, and diagonal moves past the corner of an occupied cell, are blocked and cost infinity.
+         * Moves out of an occupied cell are allowed, so a robot that starts inside the inflated area of an obstacle can still leave it.
+         * @param cell The cell index.
+         * @param cells Filled with the cells next to it that are inside the grid.
+         * @param costsOut Filled with the cost of moving from the cell to each of them.
+         * @param costsIn Filled with the cost of moving from each of them to the cell.
+         * @return The number of cells found (up to 8).
+         */
+        int moves(uint16_t cell, std::array<uint16_t, 8> &cells, std::array<float, 8> &costsOut, std::array<float, 8> &costsIn) const;
+
+        /**
+         * @brief Copies every cell's occupancy from the grid.
+         */
+        void refreshOccupancy();
+
+        /**
+         * @brief Clears the incremental search, leaving only the goal queued, so the next search starts from scratch.
+         */
+        void resetIncremental();
+
+        PlannerKey calculateKey(uint16_t cell) const;
+        void updateVertex(uint16_t cell);
+        void updateQueue(uint16_t cell);
+        void computeShortestPath();
+
+        /**
+         * @brief Smooths the chain of cells and samples it into waypoints.
+         * @param startX The robot's actual x coordinate, used as the first point.
+         * @param startY The robot's actual y coordinate, used as the first point.
+         * @param goalX The goal's actual x coordinate, used as the last point.
+         * @param goalY The goal's actual y coordinate, used as the last point.
+         * @param spacing The distance between waypoints in inches.
+         * @param velocity The target motor speed at every waypoint (0 - 127).
+         */
+        std::vector<Waypoint> buildPath(double startX, double startY, double goalX, double goalY, double spacing, double velocity);
+
+    public:
+        /**
+         * @brief Construct a new PathPlanner object.
+         * @param grid The occupancy grid to plan across. It must stay alive as long as the planner.
+         */
+        PathPlanner(OccupancyGrid *grid) : grid(grid) {
+            chain.reserve(OccupancyGrid::CELLS);
+            updates.reserve(OccupancyGrid::CELLS);
+            corners.reserve(MAX_CORNERS);
+        }
+
+        /**
+         * @brief Plans a path from scratch with A*.
+         * @param startX The x coordinate of the start (in inches).
+         * @param startY The y coordinate of the start (in inches).
+         * @param goalX The x coordinate of the goal (in inches).
+         * @param goalY The y coordinate of the goal (in inches).
+         * @param spacing The distance between waypoints in inches.
+         * @param velocity The target motor speed at every waypoint (0 - 127).
+         * @return The waypoints, or an empty path if the goal is occupied or can't be reached.
+         */
+        std::vector<Waypoint> plan(double startX, double startY, double goalX, double goalY, double spacing = 2, double velocity = 100);
+
+        /**
+         * @brief Starts incremental planning towards a goal with D* Lite. Clears the grid's recorded changes.
+         * @param startX The x coordinate of the start (in inches).
+         * @param startY The y coordinate of the start (in inches).
+         * @param goalX The x coordinate of the goal (in inches).
+         * @param goalY The y coordinate of the goal (in inches).
+         * @param spacing The distance between waypoints in inches.
+         * @param velocity The target motor speed at every waypoint (0 - 127).
+         * @return The waypoints, or an empty path if the goal is occupied or can't be reached.
+         */
+        std::vector<Waypoint> startIncremental(double startX, double startY, double goalX, double goalY, double spacing = 2, double velocity = 100);
+
+        /**
+         * @brief Repairs the incremental plan after the robot has moved or the grid has changed, then clears the grid's recorded changes.
+         * Searches from scratch instead if a change blocks the current path, or too many cells changed to track.
+         * @param startX The robot's current x coordinate (in inches).
+         * @param startY The robot's current y coordinate (in inches).
+         * @param spacing The distance between waypoints in inches.
+         * @param velocity The target motor speed at every waypoint (0 - 127).
+         * @return The waypoints, or an empty path if the goal is occupied or can't be reached.
+         */
+        std::vector<Waypoint> replan(double startX, double startY, double spacing = 2, double velocity = 100);
+};
@@ -68,6 +68,20 @@ class PIDController {
          */
         void setSmallErrorRange(double range);
 
+        /**
+         * Gets the large error range for the PID controller.
+         * 
+         * @return the large error range
+         */
+        double getLargeErrorRange();
+
+        /**
+         * Gets the small error range for the PID controller.
+         * 
+         * @return the small error range
+         */
+        double getSmallErrorRange();
+
         /**
          * Sets the output limits for the PID controller.
          * If these values are not 0, the calculate() method will automatically clamp the output to be within these limits.
@@ -165,7 +179,7 @@ class PIDController {
 
         /**
          * Resets the PID controller.
-         * This sets the accumulated error, error, and previous error to 0.
+         * This sets the accumulated error, error, previous error, and previous output to 0 and restarts the loop timer.
          * It is highly recommended to call this method before starting a new loop to ensure accurate results.
          */
         void reset();
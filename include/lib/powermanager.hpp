@@ -0,0 +1,109 @@
+#pragma once
+
+#include "drivetrain.hpp"
+#include "motorsampler.hpp"
+#include "thermalgovernor.hpp"
+#include "pros/motor_group.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * Class that shares the brain's total motor current between the drivetrain and mechanisms.
+ *
+ * Every registered motor group is a consumer with a priority and an optional callback that says when it needs full power,
+ * such as the drivetrain during motions or the intake while scoring. On each update, every consumer is guaranteed a minimum current.
+ * The rest of the budget is then handed out in priority order: consumers that need full power get up to the most their motors can draw,
+ * and the others get what they are drawing now plus some headroom. Whatever is left over is spread in priority order as extra headroom.
+ *
+ * Current draws come from a MotorSampler, so updates make no device reads. Mechanism groups must also be added to the sampler.
+ *
+ *     int intakeGroup = sampler.addMotors(&intake);
+ *     PowerManager power(&sampler);
+ *     power.addDrivetrain(&drivetrain, 2, [] { return chassis.isInMotion(); });
+ *     power.add(&intake, intakeGroup, 1, [] { return scoring; });
+ *     scheduler.add([] { power.update(); }, 50);
+ */
+class PowerManager {
+    public:
+        static constexpr size_t MAX_CONSUMERS = 12;
+        static constexpr int32_t MAX_MOTOR_CURRENT = 2500; // The most a V5 motor can draw (milliamps)
+
+    private:
+        struct Consumer {
+            pros::MotorGroup *motors = nullptr;
+            int sampleGroup = -1; // The group's index in the sampler's records
+            int priority = 0;
+            std::function<bool()> active; // Returns true while the consumer needs full power
+            int32_t motorCount = 0;
+            int32_t limit = 0; // Last limit sent per motor in milliamps, 0 if none has been sent
+        };
+
+        MotorSampler *sampler;
+        ThermalGovernor *thermalGovernor = nullptr;
+        int32_t budget; // in milliamps
+        int32_t minCurrent = 500; // Per motor, in milliamps
+        double headroom = 1.25; // How much more than its current draw an idle consumer is given
+
+        std::array<Consumer, MAX_CONSUMERS> consumers;
+        std::array<size_t, MAX_CONSUMERS> order; // Consumer indexes from highest to lowest priority
+        size_t consumerCount = 0;
+
+    public:
+        /**
+         * @brief Construct a new PowerManager object.
+         * @param sampler The sampler reading every registered motor group. It must be started separately.
+         * @param budget The total current shared between all consumers in milliamps.
+         */
+        PowerManager(MotorSampler *sampler, int32_t budget = 20000) : sampler(sampler), budget(budget) {}
+
+        /**
+         * @brief Registers a motor group as a consumer.
+         * @param motors The motor group.
+         * @param sampleGroup The group's index in the sampler's records, as returned by MotorSampler::addMotors.
+         * @param priority Higher priority consumers are given current first.
+         * @param active Returns true while the consumer needs full power. Leave empty to always give it full power when the budget allows.
+         * @return The consumer's id, or -1 if MAX_CONSUMERS consumers have already been added.
+         */
+        int add(pros::MotorGroup *motors, int sampleGroup, int priority, std::function<bool()> active = nullptr);
+
+        /**
+         * @brief Registers every motor group of a drivetrain as consumers with the same priority.
+         * @param drivetrain The drivetrain. Its groups are found in the sampler by their indexes in getMotors().
+         * @param priority Higher priority consumers are given current first.
+         * @param active Returns true while the drivetrain needs full power.
+         */
+        void addDrivetrain(Drivetrain *drivetrain, int priority, std::function<bool()> active = nullptr);
+
+        /**
+         * @brief Caps the drivetrain's groups at the limits chosen by a thermal governor.
+         * Set the governor's applyLimits parameter to false so only the power manager sets limits.
+         * @param governor The thermal governor, or nullptr to remove it.
+         */
+        void setThermalGovernor(ThermalGovernor *governor) { thermalGovernor = governor; }
+
+        /**
+         * @brief Sets the total current shared between all consumers.
+         * @param budget The budget in milliamps.
+         */
+        void setBudget(int32_t budget) { this->budget = budget; }
+
+        /**
+         * @brief Sets the current every motor is guaranteed, even at the lowest priority.
+         * @param current The current per motor in milliamps.
+         */
+        void setMinCurrent(int32_t current) { minCurrent = current; }
+
+        /**
+         * @brief Reallocates the current limits from the latest sample. Limits are only sent when they change.
+         */
+        void update();
+
+        /**
+         * @brief Get the current limit last set on a consumer.
+         * @param id The consumer's id.
+         * @return The current limit per motor in milliamps, or 0 if none has been set.
+         */
+        int32_t getCurrentLimit(int id) const { return id >= 0 && id < (int)consumerCount ? consumers[id].limit : 0; }
+};
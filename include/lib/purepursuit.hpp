@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "util/pose.hpp"
+
+/**
+ * A single point on a path, with the speed the robot should have when passing it.
+ */
+struct Waypoint {
+    double x; // in inches
+    double y; // in inches
+    double velocity; // The target motor speed at this point (0 - 127)
+};
+
+/**
+ * Parameters for following a path with pure pursuit.
+ * Values set to 0 disable their respective functionality.
+ */
+struct PurePursuitParams {
+    bool forwards = true; // Whether the robot follows the path forwards (true) or backwards (false). Differential chassis only
+    double minLookahead = 8; // The lookahead distance when stopped (in inches)
+    double maxLookahead = 16; // The lookahead distance at max speed (in inches)
+    double maxSpeed = 127; // The maximum motor speed (0 - 127)
+    double endDistance = 2; // The path is finished once the robot is this close to the last waypoint (in inches)
+};
+
+/**
+ * Class that finds the closest and lookahead points on a dense waypoint path for pure pursuit.
+ * Both searches resume from where the previous call left off instead of scanning the whole path,
+ * so each update only looks at the few segments around the robot.
+ * 
+ * For usage, call update() with the current pose every iteration, then read the closest and lookahead points.
+ */
+class PurePursuit {
+    private:
+        std::vector<Waypoint> path;
+
+        size_t closestIndex = 0;
+        double lookaheadIndex = 0; // Fractional index of the lookahead point, e.g. 2.5 is halfway between waypoints 2 and 3
+        Waypoint lookaheadPoint;
+
+        /**
+         * @brief Advances the closest waypoint index until the next waypoint is no closer to the robot.
+         * @param pose The current pose of the robot.
+         */
+        void updateClosest(Pose pose);
+
+        /**
+         * @brief Advances the lookahead point to the furthest intersection of the lookahead circle with the path.
+         * @param pose The current pose of the robot.
+         * @param lookahead The lookahead distance in inches.
+         */
+        void updateLookahead(Pose pose, double lookahead);
+
+    public:
+        /**
+         * @brief Construct a new PurePursuit object.
+         * @param path The waypoints to follow, spaced closely together (a few inches apart).
+         */
+        PurePursuit(std::vector<Waypoint> path);
+
+        /**
+         * @brief Restarts the search from the beginning of the path.
+         */
+        void reset();
+
+        /**
+         * @brief Updates the closest and lookahead points for the robot's current pose.
+         * @param pose The current pose of the robot.
+         * @param lookahead The lookahead distance in inches.
+         */
+        void update(Pose pose, double lookahead);
+
+        /**
+         * @brief Get the waypoint closest to the robot, as of the last update.
+         * @return The closest waypoint.
+         */
+        Waypoint getClosest() const;
+
+        /**
+         * @brief Get the lookahead point, as of the last update.
+         * The velocity is interpolated between the neighbouring waypoints.
+         * @return The lookahead point.
+         */
+        Waypoint getLookahead() const { return lookaheadPoint; }
+
+        /**
+         * @brief Returns whether the robot has reached the end of the path.
+         * @param pose The current pose of the robot.
+         * @param endDistance How close the robot has to be to the last waypoint in inches.
+         * @return True if the closest point is the last waypoint and the robot is within endDistance of it.
+         */
+        bool isFinished(Pose pose, double endDistance);
+
+        /**
+         * @brief Returns whether the path has no waypoints.
+         */
+        bool empty() const { return path.empty(); }
+};
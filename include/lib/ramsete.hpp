@@ -0,0 +1,59 @@
+#pragma once
+
+#include "util/pose.hpp"
+
+/**
+ * Linear and angular velocity of the robot.
+ */
+struct ChassisVelocity {
+    double linear = 0; // in inches per second
+    double angular = 0; // in radians per second, positive increases the heading
+};
+
+/**
+ * Parameters for following a trajectory with RAMSETE.
+ * Values set to 0 disable their respective functionality.
+ */
+struct RamseteParams {
+    double b = 0.0013; // Aggressiveness of the correction in rad^2 / in^2
+    double zeta = 0.7; // Damping of the correction (0 - 1)
+    double kP = 0; // Per-side velocity feedback, in motor command per inch per second of error
+};
+
+/**
+ * Class representing a RAMSETE nonlinear trajectory tracking controller for differential drivetrains.
+ * Given the reference pose and velocities from a trajectory, it corrects along-track, cross-track, and heading error together.
+ * 
+ * For usage, the calculate method should be placed inside of a loop with the current pose and the trajectory sample for the current time.
+ */
+class Ramsete {
+    private:
+        double b;
+        double zeta;
+
+    public:
+        /**
+         * Constructor for the RAMSETE controller.
+         * 
+         * @param b the aggressiveness of the correction (like a proportional gain), in rad^2 / in^2. Must be greater than 0.
+         * @param zeta the damping of the correction, between 0 and 1
+         */
+        Ramsete(double b, double zeta) : b(b), zeta(zeta) {}
+
+        /**
+         * Default constructor for the RAMSETE controller.
+         * Uses b = 0.0013 rad^2 / in^2 (2.0 rad^2 / m^2) and zeta = 0.7, which work for most robots.
+         */
+        Ramsete() : b(0.0013), zeta(0.7) {}
+
+        /**
+         * Calculates the velocities that bring the robot back onto the trajectory.
+         * 
+         * @param current the current pose of the robot
+         * @param reference the pose the robot should be at
+         * @param linearVelocity the linear velocity from the trajectory in inches per second
+         * @param angularVelocity the angular velocity from the trajectory in radians per second
+         * @return the corrected linear and angular velocity
+         */
+        ChassisVelocity calculate(Pose current, Pose reference, double linearVelocity, double angularVelocity) const;
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "purepursuit.hpp"
+#include "util/pose.hpp"
+
+/**
+ * A point on a spline, looked up by distance traveled.
+ */
+struct SplinePoint {
+    Pose pose; // Heading uses the same convention as the tracked pose
+    double curvature = 0; // in 1/inches, positive increases the heading
+};
+
+/**
+ * Keeps track of where the last lookup on a spline was, so the next lookup only has to move a short distance.
+ * Each follower should use its own cursor.
+ */
+struct SplineCursor {
+    size_t segment = 0;
+    size_t tableIndex = 0;
+};
+
+/**
+ * Class representing a single spline segment, stored as a polynomial of up to degree 5 in the parameter u (0 - 1).
+ * Each segment precomputes a table of arc length against u when it is constructed,
+ * so points can be looked up by distance traveled without integrating at runtime.
+ */
+class SplineSegment {
+    public:
+        static constexpr size_t TABLE_SIZE = 32;
+
+    private:
+        // Polynomial coefficients, lowest degree first
+        std::array<double, 6> xCoeffs = {};
+        std::array<double, 6> yCoeffs = {};
+
+        // arcLengths[i] is the distance traveled at u = i / TABLE_SIZE
+        std::array<double, TABLE_SIZE + 1> arcLengths = {};
+
+        SplineSegment(std::array<double, 6> xCoeffs, std::array<double, 6> yCoeffs);
+
+        /**
+         * @brief Evaluates the derivatives of the polynomial at u.
+         * @param u The spline parameter (0 - 1).
+         * @param order The derivative to evaluate (0 for the position).
+         * @return The x and y derivatives as a Pose (theta is unused).
+         */
+        Pose evaluate(double u, int order) const;
+
+    public:
+        /**
+         * @brief Creates a cubic Hermite segment that leaves start and arrives at end along their headings.
+         * @param start The start point and heading.
+         * @param end The end point and heading.
+         * @param tangentScale The tangent lengths as a multiple of the distance between the points. Higher values make wider curves.
+         * @return The segment.
+         */
+        static SplineSegment cubicHermite(Pose start, Pose end, double tangentScale = 1);
+
+        /**
+         * @brief Creates a quintic Hermite segment that leaves start and arrives at end along their headings.
+         * The second derivative is 0 at both ends, so segments joined together have continuous curvature.
+         * @param start The start point and heading.
+         * @param end The end point and heading.
+         * @param tangentScale The tangent lengths as a multiple of the distance between the points. Higher values make wider curves.
+         * @return The segment.
+         */
+        static SplineSegment quinticHermite(Pose start, Pose end, double tangentScale = 1);
+
+        /**
+         * @brief Creates a cubic Bezier segment from its four control points. The control point headings are unused.
+         * @param p0 The start point.
+         * @param p1 The first control point.
+         * @param p2 The second control point.
+         * @param p3 The end point.
+         * @return The segment.
+         */
+        static SplineSegment cubicBezier(Pose p0, Pose p1, Pose p2, Pose p3);
+
+        /**
+         * @brief Get the length of the segment.
+         * @return The length in inches.
+         */
+        double getLength() const { return arcLengths[TABLE_SIZE]; }
+
+        /**
+         * @brief Get the point at a parameter value.
+         * @param u The spline parameter (0 - 1).
+         * @return The point, heading, and curvature at u.
+         */
+        SplinePoint pointAt(double u) const;
+
+        /**
+         * @brief Converts a distance along the segment to a parameter value using the arc length table.
+         * The search starts from tableIndex and moves it to the interval containing the distance.
+         * @param distance The distance along the segment in inches.
+         * @param tableIndex The table interval of the last lookup, updated to the interval of this lookup.
+         * @return The spline parameter (0 - 1).
+         */
+        double parameterAt(double distance, size_t &tableIndex) const;
+};
+
+/**
+ * Class representing a path made of spline segments joined end to end.
+ * All memory is allocated when the spline is constructed. Lookups by distance only walk from the cursor's last position,
+ * so looking up steadily increasing distances every iteration is O(1) amortized.
+ */
+class Spline {
+    private:
+        std::vector<SplineSegment> segments;
+        std::vector<double> startDistances; // Distance along the spline at the start of each segment
+        double length = 0;
+
+    public:
+        /**
+         * @brief Construct a new Spline object.
+         * @param segments The segments of the spline, in order.
+         */
+        Spline(std::vector<SplineSegment> segments);
+
+        /**
+         * @brief Construct a new Spline object through a list of poses, joining them with cubic or quintic Hermite segments.
+         * @param waypoints The poses to pass through, in order.
+         * @param quintic If true, quintic Hermite segments are used for continuous curvature.
+         */
+        Spline(std::vector<Pose> waypoints, bool quintic);
+
+        /**
+         * @brief Get the length of the spline.
+         * @return The length in inches.
+         */
+        double getLength() const { return length; }
+
+        /**
+         * @brief Get the point at a distance along the spline. Distances outside the spline are clamped.
+         * @param distance The distance along the spline in inches.
+         * @param cursor The cursor of the last lookup, updated to this lookup.
+         * @return The point, heading, and curvature at that distance.
+         */
+        SplinePoint pointAt(double distance, SplineCursor &cursor) const;
+
+        /**
+         * @brief Samples the spline into evenly spaced waypoints for the pure pursuit follower.
+         * @param spacing The distance between waypoints in inches.
+         * @param velocity The target motor speed at every waypoint (0 - 127).
+         * @return The waypoints.
+         */
+        std::vector<Waypoint> toWaypoints(double spacing, double velocity) const;
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "motorsampler.hpp"
+#include "telemetryformat.hpp"
+#include "util/pose.hpp"
+#include "pros/rtos.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Class that streams binary telemetry over the brain's USB serial port (see lib/telemetryformat.hpp).
+ *
+ * Logging a sample only copies it into a fixed-size queue, so it is cheap enough to call from control loops, even at 1 kHz.
+ * A low-priority task encodes the queue into compact delta-coded packets and writes them out, never faster than the bandwidth limit.
+ * If the stream falls behind, new samples are dropped and the number dropped is sent in the stream instead of blocking the caller.
+ *
+ * Starting the stream turns off the PROS terminal's own framing on stdout, so printed text is mixed into the binary stream
+ * and the PROS terminal can't show it. Capture the port to a file on a computer and decode it with tools/telemetry2csv.cpp.
+ *
+ *     Telemetry telemetry;
+ *     telemetry.setMotorSampler(&sampler);
+ *     telemetry.start();
+ *     telemetry.logPose(chassis.getPose());
+ */
+class Telemetry {
+    public:
+        static constexpr size_t QUEUE_SIZE = 256;
+
+    private:
+        struct Entry {
+            std::atomic<bool> ready{false};
+            uint8_t type = 0;
+            uint8_t id = 0;
+            uint32_t time = 0; // from pros::micros()
+            std::array<int32_t, 3> values = {}; // Already scaled to the format's units
+        };
+
+        // Multi-producer, single-consumer queue. Producers reserve a slot by advancing writeIndex, then mark it ready
+        std::array<Entry, QUEUE_SIZE> entries;
+        std::atomic<uint32_t> writeIndex{0};
+        std::atomic<uint32_t> readIndex{0};
+        std::atomic<uint32_t> droppedCount{0};
+        uint32_t reportedDrops = 0;
+
+        MotorSampler *motorSampler = nullptr;
+        uint32_t lastMotorRecord = 0;
+
+        uint32_t maxBytesPerSecond;
+        double availableBytes = 0;
+        uint32_t lastRefill = 0;
+        std::atomic<bool> running{false};
+        std::atomic<bool> stopped{true}; // Set by the stream task once it has exited
+
+        // The packet being built, and the last record in it for differencing
+        std::array<uint8_t, telemetry_format::MAX_PACKET_SIZE> packet;
+        size_t packetSize = 0;
+        uint8_t packetType = 0;
+        uint8_t packetId = 0;
+        uint32_t lastTime = 0;
+        std::array<int32_t, 3> lastValues = {};
+
+        /**
+         * @brief Queues a record for the stream task.
+         * @return False if the queue was full and the record was dropped.
+         */
+        bool push(uint8_t type, uint8_t id, std::array<int32_t, 3> values);
+
+        /**
+         * @brief Adds a queued record to the packet being built, sending the packet first if the record doesn't fit or has a different type.
+         */
+        void append(const Entry &entry);
+
+        /**
+         * @brief Sends the packet being built, if any, and starts a new one.
+         */
+        void flush();
+
+        /**
+         * @brief Encodes and writes a packet, waiting for the bandwidth limit if needed.
+         * @param data The packet.
+         * @param size The packet's size.
+         */
+        void send(const uint8_t *data, size_t size);
+
+        /**
+         * @brief Sends the latest motor record from the sampler, if there is a new one.
+         */
+        void sendMotors();
+
+    public:
+        /**
+         * @brief Construct a new Telemetry object.
+         * @param maxBytesPerSecond The most bytes written to the serial port per second.
+         */
+        Telemetry(uint32_t maxBytesPerSecond = 20000) : maxBytesPerSecond(maxBytesPerSecond == 0 ? 1 : maxBytesPerSecond) {}
+
+        /**
+         * @brief Starts the stream task if it is not already running.
+         * If the stream was just stopped, this waits for the previous task to finish its last pass, so two tasks never write at once.
+         * @param priority The task priority. Keep it below the control tasks.
+         */
+        void start(uint32_t priority = TASK_PRIORITY_MIN + 1);
+
+        /**
+         * @brief Stops the stream task after its current pass.
+         */
+        void stop() { running = false; }
+
+        /**
+         * @brief Streams the motor records of a sampler, each new record once.
+         * @param sampler The sampler, or nullptr to stop streaming motor records.
+         */
+        void setMotorSampler(MotorSampler *sampler) { motorSampler = sampler; }
+
+        /**
+         * @brief Logs the robot's pose. Safe to call from any task.
+         * @param pose The pose.
+         */
+        void logPose(const Pose &pose);
+
+        /**
+         * @brief Logs one step of a PID controller. Safe to call from any task.
+         * @param id An id that tells controllers apart in the decoded stream.
+         * @param error The controller's error.
+         * @param output The controller's output.
+         */
+        void logPid(uint8_t id, double error, double output);
+
+        /**
+         * @brief Get the number of records dropped because the stream fell behind.
+         * @return The number of records.
+         */
+        uint32_t getDroppedCount() const { return droppedCount.load(std::memory_order_relaxed); }
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Binary telemetry format.
+ * The stream is a sequence of frames, each a COBS-encoded packet followed by a 0 byte, so a reader can resynchronize at any 0.
+ * A packet starts with its type and holds one or more records of that type. The first record in a packet is stored in full
+ * and the rest as differences from the record before, so losing a frame never corrupts the frames after it.
+ *
+ * Integers are varints (7 bits per byte, least significant first, high bit set on every byte but the last),
+ * and signed values are zigzag encoded first so small negative numbers stay small. Times are pros::micros() truncated to 32 bits.
+ *
+ *     POSE:    type, then per record: time, x, y, theta (zigzag, see the scales below)
+ *     PID:     type, controller id (1 byte), then per record: time, error, output (zigzag)
+ *     MOTORS:  type, time, motor count (1 byte), then per motor: flags (1 byte), velocity, current, voltage (zigzag), temperature (1 byte)
+ *              Fields are the same as MotorSample (see lib/motorsampler.hpp), and are never differenced
+ *     DROPPED: type, the number of records dropped because the stream fell behind
+ *
+ * The stream is decoded to CSV on a computer with tools/telemetry2csv.cpp.
+ */
+namespace telemetry_format {
+    enum PacketType : uint8_t {
+        POSE = 1,
+        PID = 2,
+        MOTORS = 3,
+        DROPPED = 4
+    };
+
+    constexpr double POSITION_SCALE = 0.01; // inches per unit
+    constexpr double HEADING_SCALE = 0.0001; // radians per unit
+    constexpr double PID_SCALE = 0.001; // error and output units per unit
+
+    constexpr size_t MAX_PACKET_SIZE = 254; // Packets fit in a single COBS block
+    constexpr size_t MAX_FRAME_SIZE = MAX_PACKET_SIZE + 2; // The COBS overhead byte and the 0 delimiter
+    constexpr size_t MAX_VARINT_SIZE = 5;
+
+    inline uint32_t zigzag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+    inline int32_t unzigzag(uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+
+    /**
+     * @brief Writes a varint.
+     * @param out Where to write, with room for MAX_VARINT_SIZE bytes.
+     * @param value The value.
+     * @return The number of bytes written.
+     */
+    inline size_t writeVarint(uint8_t *out, uint32_t value) {
+        size_t size = 0;
+        while (value >= 0x80) {
+            out[size++] = (uint8_t)(value | 0x80);
+            value >>= 7;
+        }
+        out[size++] = (uint8_t)value;
+        return size;
+    }
+
+    /**
+     * @brief Reads a varint.
+     * @param in Where to read from.
+     * @param size The number of bytes available.
+     * @param value The value read.
+     * @return The number of bytes read, or 0 if the varint is cut off or too long.
+     */
+    inline size_t readVarint(const uint8_t *in, size_t size, uint32_t &value) {
+        value = 0;
+        for (size_t i = 0; i < size && i < MAX_VARINT_SIZE; i++) {
+            value |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+            if ((in[i] & 0x80) == 0) {
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief COBS-encodes a packet into a frame, including the 0 delimiter.
+     * @param in The packet, at most MAX_PACKET_SIZE bytes.
+     * @param size The packet's size.
+     * @param out Where to write the frame, with room for size + 2 bytes.
+     * @return The frame's size.
+     */
+    inline size_t cobsEncode(const uint8_t *in, size_t size, uint8_t *out) {
+        size_t code = 0; // Index of the current block's length byte
+        size_t length = 1;
+        for (size_t i = 0; i < size; i++) {
+            if (in[i] == 0) {
+                out[code] = (uint8_t)(length - code);
+                code = length++;
+            } else {
+                out[length++] = in[i];
+            }
+        }
+        out[code] = (uint8_t)(length - code);
+        out[length++] = 0;
+        return length;
+    }
+
+    /**
+     * @brief Decodes a COBS frame back into a packet.
+     * @param in The frame, without the 0 delimiter.
+     * @param size The frame's size.
+     * @param out Where to write the packet, with room for size bytes.
+     * @return The packet's size, or 0 if the frame is malformed.
+     */
+    inline size_t cobsDecode(const uint8_t *in, size_t size, uint8_t *out) {
+        size_t length = 0;
+        size_t i = 0;
+        while (i < size) {
+            uint8_t code = in[i++];
+            if (code == 0 || i + code - 1 > size) {
+                return 0;
+            }
+            for (uint8_t j = 1; j < code; j++) {
+                out[length++] = in[i++];
+            }
+            if (code != 0xFF && i < size) {
+                out[length++] = 0;
+            }
+        }
+        return length;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "drivetrain.hpp"
+#include "motorsampler.hpp"
+#include "thermalmodel.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Class that estimates each drivetrain motor's temperature and lowers current limits before the motors throttle themselves.
+ *
+ * Each motor is modelled as a first-order thermal RC circuit (see ThermalModel).
+ * The estimate is integrated from the current draw and slowly corrected towards the motor's own temperature reading,
+ * which is only reported in coarse steps.
+ *
+ * From the estimate, the governor predicts how long each motor can keep its current draw before reaching throttleTemperature.
+ * Each motor group is given the highest current limit that keeps its hottest motor below throttleTemperature until the end
+ * of the match (or the horizon), so the drivetrain loses a little power early instead of a lot of power late.
+ *
+ * ThermalParams' defaults must be calibrated before the governor does anything (see ThermalParams).
+ *
+ * Readings come from a MotorSampler, so updates make no device reads. Call update() periodically, such as from a LoopScheduler:
+ *
+ *     ThermalGovernor governor(&drivetrain, &sampler);
+ *     governor.startMatch(105000);
+ *     scheduler.add([] { governor.update(); }, 100);
+ */
+class ThermalGovernor {
+    private:
+        Drivetrain *drivetrain;
+        MotorSampler *sampler;
+        ThermalParams params;
+        ThermalModel model;
+
+        std::array<double, MotorRecord::MAX_MOTORS> temperatures = {}; // Estimated temperatures in degrees Celsius
+        std::array<double, MotorRecord::MAX_MOTORS> currents = {}; // Latest current draws in amps
+        std::array<int32_t, Drivetrain::MAX_MOTOR_GROUPS> groupLimits = {}; // Last limit sent to each group in milliamps
+        size_t motorCount = 0;
+        uint32_t lastTimestamp = 0;
+        uint32_t matchEnd = 0; // From pros::millis(), 0 if no match has been started
+        bool initialized = false;
+
+    public:
+        /**
+         * @brief Construct a new ThermalGovernor object.
+         * @param drivetrain The drivetrain whose current limits are set.
+         * @param sampler The sampler reading the drivetrain's motors. It must be started separately.
+         * @param params The thermal model parameters.
+         */
+        ThermalGovernor(Drivetrain *drivetrain, MotorSampler *sampler, ThermalParams params = {})
+        : drivetrain(drivetrain), sampler(sampler), params(params), model(params) {}
+
+        /**
+         * @brief Sets the time left in the match, so the current limits only need to last until its end.
+         * @param duration The time left in milliseconds.
+         */
+        void startMatch(uint32_t duration);
+
+        /**
+         * @brief Updates the temperature estimates from the latest sample, and the current limits if they changed.
+         */
+        void update();
+
+        /**
+         * @brief Get a motor's estimated temperature.
+         * @param motor The motor's index in the sampler's records.
+         * @return The temperature in degrees Celsius.
+         */
+        double getTemperature(size_t motor) const { return motor < motorCount ? temperatures[motor] : 0; }
+
+        /**
+         * @brief Predicts how long a motor can keep its current draw before it throttles itself.
+         * @param motor The motor's index in the sampler's records.
+         * @return The time in seconds, 0 if it is already throttling, or infinity if it never will at this current.
+         */
+        double getTimeToThrottle(size_t motor) const;
+
+        /**
+         * @brief Get the current limit the governor chose for a motor group, whether or not it applied it.
+         * @param group The motor group's index in getMotors().
+         * @return The current limit per motor in milliamps, or 0 if none has been chosen.
+         */
+        int32_t getCurrentLimit(size_t group) const { return group < groupLimits.size() ? groupLimits[group] : 0; }
+};
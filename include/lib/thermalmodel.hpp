@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+/**
+ * Parameters of the motor thermal model and the current limiting.
+ *
+ * The defaults are not calibrated. With the default riseCoefficient, a drivetrain motor doesn't reach throttleTemperature
+ * in a normal match, so ThermalGovernor never lowers a limit until the model is measured on your robot:
+ * run a motor at a steady current (for example stalled against a wall) with a MotorSampler running, log the temperature,
+ * and set riseCoefficient to (final temperature - ambientTemperature) / current^2 and timeConstant to the time it took to
+ * get 63% of the way there. tools/thermalsim.cpp shows what the governor does with a set of parameters.
+ */
+struct ThermalParams {
+    double timeConstant = 240; // How quickly a motor's temperature approaches its steady state (seconds)
+    double riseCoefficient = 6; // Steady-state temperature rise per amp squared of current (degrees Celsius per A^2)
+    double ambientTemperature = 25; // in degrees Celsius
+    double throttleTemperature = 55; // The temperature where the motors start limiting themselves (degrees Celsius)
+    double horizon = 105; // How long the motors should last before throttling, when no match has been started (seconds)
+    int32_t minCurrentLimit = 1000; // The current limit is never set below this (milliamps)
+    int32_t maxCurrentLimit = 2500; // The current limit with no thermal concern (milliamps)
+    double measurementTimeConstant = 2; // How quickly the estimate follows the motor's temperature readings (seconds). Set to 0 to ignore the readings
+    bool applyLimits = true; // Whether the governor sets the limits itself. Turn off when a PowerManager sets them instead
+};
+
+/**
+ * First-order thermal RC model of a motor: its temperature approaches ambient + riseCoefficient * current^2 with the
+ * time constant timeConstant. Used by ThermalGovernor to estimate temperatures and choose current limits.
+ * This has no PROS dependency, so it can be simulated on a computer (see tools/thermalsim.cpp).
+ */
+class ThermalModel {
+    private:
+        ThermalParams params;
+
+    public:
+        /**
+         * @brief Construct a new ThermalModel object.
+         * @param params The thermal model parameters.
+         */
+        ThermalModel(ThermalParams params = {}) : params(params) {}
+
+        /**
+         * @brief Advances a motor's temperature.
+         * @param temperature The temperature in degrees Celsius.
+         * @param current The current draw over the step in amps.
+         * @param dt The length of the step in seconds.
+         * @return The temperature at the end of the step.
+         */
+        double step(double temperature, double current, double dt) const {
+            double steady = params.ambientTemperature + params.riseCoefficient * current * current;
+            return temperature + (steady - temperature) * (1 - std::exp(-dt / params.timeConstant));
+        }
+
+        /**
+         * @brief Pulls a temperature estimate towards a reading. The pull depends on the time since the last correction,
+         * so the estimate follows the readings equally fast however often it is corrected.
+         * @param estimate The estimated temperature in degrees Celsius.
+         * @param reading The motor's reported temperature in degrees Celsius.
+         * @param dt The time since the last correction in seconds.
+         * @return The corrected estimate.
+         */
+        double correct(double estimate, double reading, double dt) const {
+            if (params.measurementTimeConstant <= 0) {
+                return estimate;
+            }
+            return estimate + (reading - estimate) * (1 - std::exp(-dt / params.measurementTimeConstant));
+        }
+
+        /**
+         * @brief Get the highest constant current that keeps a motor below the throttle temperature for a time.
+         * @param temperature The motor's current temperature in degrees Celsius.
+         * @param time The time it has to last in seconds.
+         * @return The current in amps.
+         */
+        double getSustainableCurrent(double temperature, double time) const {
+            // At a constant current, T(t) = steady + (T0 - steady) * e^(-t / tau). Solve for the steady state that reaches the throttle temperature at t = time
+            double decay = std::exp(-time / params.timeConstant);
+            double steady = (params.throttleTemperature - temperature * decay) / (1 - decay);
+            double rise = steady - params.ambientTemperature;
+            if (rise <= 0 || params.riseCoefficient <= 0) {
+                return 0;
+            }
+            return std::sqrt(rise / params.riseCoefficient);
+        }
+
+        /**
+         * @brief Get the current limit that keeps a motor below the throttle temperature for a time.
+         * @param temperature The motor's current temperature in degrees Celsius.
+         * @param time The time it has to last in seconds. 0 means there is nothing left to save the motor for.
+         * @return The current limit in milliamps, between minCurrentLimit and maxCurrentLimit.
+         */
+        int32_t getCurrentLimit(double temperature, double time) const {
+            if (time <= 0) {
+                return params.maxCurrentLimit;
+            }
+            double current = std::min(getSustainableCurrent(temperature, time), params.maxCurrentLimit / 1000.0);
+            return std::clamp((int32_t)(current * 1000), params.minCurrentLimit, params.maxCurrentLimit);
+        }
+
+        /**
+         * @brief Predicts how long a motor can keep a current draw before it throttles itself.
+         * @param temperature The motor's current temperature in degrees Celsius.
+         * @param current The current draw in amps.
+         * @return The time in seconds, 0 if it is already throttling, or infinity if it never will at this current.
+         */
+        double getTimeToThrottle(double temperature, double current) const {
+            if (temperature >= params.throttleTemperature) {
+                return 0;
+            }
+            double steady = params.ambientTemperature + params.riseCoefficient * current * current;
+            if (steady <= params.throttleTemperature) {
+                return INFINITY;
+            }
+            return -params.timeConstant * std::log((params.throttleTemperature - steady) / (temperature - steady));
+        }
+};
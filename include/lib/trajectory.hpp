@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "util/pose.hpp"
+
+/**
+ * Binary trajectory format.
+ * A trajectory file is a TrajectoryHeader followed by sampleCount TrajectorySamples, sampled every sampleTime milliseconds.
+ * All fields are little-endian and stored as fixed-point integers to keep files small (12 bytes per sample).
+ * Trajectories are generated ahead of time on a computer with tools/trajgen.cpp.
+ */
+namespace trajectory_format {
+    constexpr char MAGIC[4] = {'T', 'R', 'J', 'B'};
+    constexpr uint16_t VERSION = 1;
+
+    constexpr double POSITION_SCALE = 0.01; // inches per unit, +-327 inches
+    constexpr double HEADING_SCALE = 0.0001; // radians per unit, +-3.27 radians
+    constexpr double VELOCITY_SCALE = 0.01; // inches per second per unit, +-327 inches per second
+    constexpr double ANGULAR_VELOCITY_SCALE = 0.001; // radians per second per unit, +-32 radians per second
+    constexpr double ACCELERATION_SCALE = 0.01; // inches per second squared per unit, +-327 inches per second squared
+}
+
+#pragma pack(push, 1)
+struct TrajectoryHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t sampleTime; // in milliseconds
+    uint32_t sampleCount;
+};
+
+struct TrajectorySample {
+    int16_t x;
+    int16_t y;
+    int16_t theta;
+    int16_t velocity;
+    int16_t angularVelocity;
+    int16_t acceleration;
+};
+#pragma pack(pop)
+
+/**
+ * The decoded state of a trajectory at a point in time.
+ */
+struct TrajectoryPoint {
+    Pose pose; // Heading uses the same convention as the tracked pose
+    double velocity = 0; // in inches per second
+    double angularVelocity = 0; // in radians per second, positive increases the heading
+    double acceleration = 0; // in inches per second squared
+};
+
+/**
+ * Class representing a time-parameterized trajectory stored in the binary trajectory format.
+ * Samples are evenly spaced in time, so looking up the state at any time is O(1).
+ *
+ * The data can either be linked into the program as a const array (see tools/trajgen.cpp --cpp),
+ * or loaded from a file on the SD card. Load files in initialize() so autonomous doesn't wait on the SD card.
+ */
+class Trajectory {
+    private:
+        std::vector<uint8_t> storage; // Owns the data when loaded from a file
+        const uint8_t *externalData = nullptr; // Points at the data when it is linked into the program
+        TrajectoryHeader header = {};
+        bool valid = false;
+
+        /**
+         * @brief Validates the header and points the trajectory at the data.
+         * @param buffer The raw trajectory data.
+         * @param size The size of the data in bytes.
+         */
+        void parse(const uint8_t *buffer, size_t size);
+
+        /**
+         * @brief Get the start of the sample data. Looked up on every access so copies of the trajectory stay valid.
+         */
+        const uint8_t *samples() const;
+
+        /**
+         * @brief Decodes a single sample.
+         * @param index The index of the sample.
+         * @return The decoded sample.
+         */
+        TrajectoryPoint decode(size_t index) const;
+
+    public:
+        /**
+         * @brief Construct an empty Trajectory object.
+         */
+        Trajectory() {}
+
+        /**
+         * @brief Construct a new Trajectory object from data linked into the program. The data is not copied.
+         * @param buffer The raw trajectory data.
+         * @param size The size of the data in bytes.
+         */
+        Trajectory(const uint8_t *buffer, size_t size);
+
+        /**
+         * @brief Loads a trajectory from a file, e.g. "/usd/skills1.traj".
+         * @param path The path to the file.
+         * @return True if the file was read and is a valid trajectory, false otherwise.
+         */
+        bool load(const char *path);
+
+        /**
+         * @brief Returns whether the trajectory holds valid data.
+         */
+        bool isValid() const { return valid; }
+
+        /**
+         * @brief Get the duration of the trajectory.
+         * @return The duration in seconds.
+         */
+        double getDuration() const;
+
+        /**
+         * @brief Get the state of the trajectory at a point in time. Times outside the trajectory are clamped.
+         * The state is interpolated between the two nearest samples.
+         * @param time The time since the start of the trajectory in seconds.
+         * @return The state at that time.
+         */
+        TrajectoryPoint sample(double time) const;
+};
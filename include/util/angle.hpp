@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * @brief Converts an angle from degrees to radians.
+ * @param degrees The angle in degrees.
+ * @return The angle in radians.
+ */
+double degToRad(double degrees);
+
+/**
+ * @brief Converts an angle from radians to degrees.
+ * @param radians The angle in radians.
+ * @return The angle in degrees.
+ */
+double radToDeg(double radians);
+
+/**
+ * @brief Wraps an angle into the range [-pi, pi].
+ * @param radians The angle to wrap (in radians).
+ * @return The equivalent angle in the range [-pi, pi].
+ */
+double wrapAngle(double radians);
+
+/**
+ * @brief Calculates the shortest signed angle that rotates current onto target.
+ * Positive values mean the heading has to increase to reach the target.
+ * @param target The target angle (in radians).
+ * @param current The current angle (in radians).
+ * @return The shortest angular error in the range [-pi, pi].
+ */
+double angleError(double target, double current);
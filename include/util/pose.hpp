@@ -57,6 +57,14 @@ class Pose {
          */
         double angleTo(const Pose& other);
 
+        /**
+         * @brief Calculates the heading the robot would need to face to drive straight at another pose.
+         * Uses the same convention as the tracked heading: 0 faces +y and forward is (-sin(theta), cos(theta)).
+         * @param other The other pose to face.
+         * @return The heading in radians.
+         */
+        double headingTo(const Pose& other);
+
         /**
          * @brief Rotates the pose by a given angle.
          * @param angle The angle to rotate by (in radians).
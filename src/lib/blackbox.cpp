@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <cstring>
+#include "lib/blackbox.hpp"
+
+using namespace blackbox_format;
+
+/**
+ * @brief Copies a record into the block being filled.
+ * @param record The record. Its time is set here.
+ */
+void BlackBox::append(BlackBoxRecord record) {
+    if (!running) {
+        return;
+    }
+
+    mutex.take();
+    // Stamped under the mutex, so records from different tasks are stored in time order
+    record.time = pros::micros();
+    if (record.type == POSE && decimation > 1 && decimationCounter++ % decimation != 0) {
+        mutex.give();
+        return;
+    }
+
+    blocks[(oldestFull + fullCount) % BLOCK_COUNT][fillCount++] = record;
+    if (fillCount == RECORDS_PER_BLOCK) {
+        fillCount = 0;
+        // Every other block is full and waiting, so there is nowhere to start the next block
+        if (fullCount == BLOCK_COUNT - 1) {
+            droppedCount += RECORDS_PER_BLOCK;
+            if (policy == OverflowPolicy::DECIMATE) {
+                // Decimation wasn't enough, so the block that was just filled is lost
+                mutex.give();
+                return;
+            }
+            oldestFull = (oldestFull + 1) % BLOCK_COUNT;
+            fullCount--;
+        }
+        fullCount++;
+
+        if (policy == OverflowPolicy::DECIMATE && fullCount >= BLOCK_COUNT / 2 && decimation < MAX_DECIMATION) {
+            decimation *= 2;
+        }
+    }
+    mutex.give();
+}
+
+/**
+ * @brief Takes the oldest full block, or pads and takes the partial block if requested, and writes it to the card.
+ * @param includePartial Whether to write the block being filled if there are no full blocks.
+ * @return Whether a block was written.
+ */
+bool BlackBox::writeBlock(bool includePartial) {
+    mutex.take();
+    if (fullCount > 0) {
+        writeBuffer = blocks[oldestFull];
+        oldestFull = (oldestFull + 1) % BLOCK_COUNT;
+        fullCount--;
+        // Caught up, so keep more records again
+        if (fullCount == 0 && decimation > 1) {
+            decimation /= 2;
+        }
+    } else if (includePartial && fillCount > 0) {
+        // With no full blocks, the block being filled is the oldest one. Pad it out and start it over
+        const Block &partial = blocks[oldestFull];
+        std::copy(partial.begin(), partial.begin() + fillCount, writeBuffer.begin());
+        std::fill(writeBuffer.begin() + fillCount, writeBuffer.end(), BlackBoxRecord{});
+        fillCount = 0;
+    } else {
+        mutex.give();
+        return false;
+    }
+    mutex.give();
+
+    fwrite(writeBuffer.data(), sizeof(Block), 1, file);
+    fflush(file);
+    return true;
+}
+
+/**
+ * @brief Logs the latest motor record from the sampler, if there is a new one.
+ */
+void BlackBox::logMotors() {
+    MotorRecord record;
+    if (motorSampler == nullptr || motorSampler->getRecordCount() == lastMotorRecord || !motorSampler->getLatest(record)) {
+        return;
+    }
+    lastMotorRecord = motorSampler->getRecordCount();
+
+    // Motor records are decimated a whole snapshot at a time
+    if (decimation > 1 && lastMotorRecord % decimation != 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < record.motorCount; i++) {
+        const MotorSample &sample = record.motors[i];
+        BlackBoxRecord motor = {};
+        motor.type = MOTOR;
+        motor.id = (uint8_t)i;
+        motor.values[0] = sample.getVelocity();
+        motor.values[1] = sample.currentDraw;
+        motor.values[2] = sample.voltage;
+        motor.values[3] = sample.temperature;
+        motor.values[4] = sample.getGroup();
+        motor.values[5] = sample.isConnected();
+        append(motor);
+    }
+}
+
+/**
+ * @brief Creates the log file and starts the writer task. Replaces any file with the same name.
+ * @param path The file to write, on the SD card (starting with /usd/).
+ * @param priority The writer task's priority. Keep it below the control tasks.
+ * @return False if a log is already running or the file couldn't be created, such as when no SD card is inserted.
+ */
+bool BlackBox::start(const char *path, uint32_t priority) {
+    if (running || !stopped) {
+        return false;
+    }
+    file = fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    // The header gets a block to itself, so every record block starts on a block boundary
+    BlackBoxHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(BlackBoxRecord);
+    header.blockSize = BLOCK_SIZE;
+    header.startTime = pros::millis();
+    std::fill(writeBuffer.begin(), writeBuffer.end(), BlackBoxRecord{});
+    std::memcpy(writeBuffer.data(), &header, sizeof(header));
+    fwrite(writeBuffer.data(), sizeof(Block), 1, file);
+    fflush(file);
+
+    oldestFull = 0;
+    fullCount = 0;
+    fillCount = 0;
+    decimation = 1;
+    droppedCount = 0;
+    lastMotorRecord = motorSampler != nullptr ? motorSampler->getRecordCount() : 0;
+    running = true;
+    stopped = false;
+
+    pros::Task task([this] {
+        uint32_t lastFlush = pros::millis();
+        while (running) {
+            logMotors();
+            if (pros::millis() - lastFlush >= flushInterval) {
+                // Records keep arriving while a block is written, so only the partial block present now is flushed
+                while (writeBlock(false)) {}
+                writeBlock(true);
+                lastFlush = pros::millis();
+            } else if (!writeBlock(false)) {
+                pros::delay(10);
+            }
+        }
+
+        while (writeBlock(false)) {}
+        writeBlock(true);
+        fclose(file);
+        file = nullptr;
+        stopped = true;
+    }, priority, TASK_STACK_DEPTH_DEFAULT, "Black Box");
+    return true;
+}
+
+/**
+ * @brief Writes everything logged so far and closes the file. Blocks until done.
+ */
+void BlackBox::stop() {
+    running = false;
+    while (!stopped) {
+        pros::delay(5);
+    }
+}
+
+/**
+ * @brief Logs the robot's pose and velocity.
+ * @param pose The pose.
+ * @param velocity The velocity, as returned by Chassis::getVelocity().
+ */
+void BlackBox::logPose(const Pose &pose, const Pose &velocity) {
+    BlackBoxRecord record = {};
+    record.type = POSE;
+    record.values[0] = pose.getX();
+    record.values[1] = pose.getY();
+    record.values[2] = pose.getTheta();
+    record.values[3] = velocity.getX();
+    record.values[4] = velocity.getY();
+    record.values[5] = velocity.getTheta();
+    append(record);
+}
+
+/**
+ * @brief Logs the commands sent to the drivetrain.
+ * @param commands The command for each motor group.
+ * @param mode How the commands were sent.
+ */
+void BlackBox::logCommands(const std::array<double, Drivetrain::MAX_MOTOR_GROUPS> &commands, MotorCommand mode) {
+    BlackBoxRecord record = {};
+    record.type = COMMAND;
+    record.id = (uint8_t)mode;
+    for (size_t i = 0; i < commands.size(); i++) {
+        record.values[i] = commands[i];
+    }
+    append(record);
+}
+
+/**
+ * @brief Logs sensor readings.
+ * @param id An id that tells sensors apart in the log.
+ * @param values Up to 6 readings.
+ */
+void BlackBox::logSensor(uint8_t id, const std::array<float, 6> &values) {
+    BlackBoxRecord record = {};
+    record.type = SENSOR;
+    record.id = id;
+    std::copy(values.begin(), values.end(), record.values);
+    append(record);
+}
+
+/**
+ * @brief Logs an event, such as a detected fault.
+ * @param id An id that tells events apart in the log.
+ * @param values Details of the event.
+ */
+void BlackBox::logEvent(uint8_t id, const std::array<float, 6> &values) {
+    BlackBoxRecord record = {};
+    record.type = EVENT;
+    record.id = id;
+    std::copy(values.begin(), values.end(), record.values);
+    append(record);
+}
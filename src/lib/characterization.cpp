@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cmath>
+#include "lib/characterization.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Runs one driving test and logs its samples.
+ * @param direction 1 to drive forwards, -1 to drive backwards.
+ * @param quasistatic True for a quasistatic test (rising speed), false for a dynamic test (speed step).
+ * @param params The characterization parameters.
+ * @return The index of the test's first sample.
+ */
+size_t Characterizer::runDriveTest(double direction, bool quasistatic, const CharacterizationParams &params) {
+    // The tracking task updates the pose and velocity every 20 ms, so sampling faster would only log repeats
+    const uint32_t samplePeriod = 20;
+
+    size_t first = sampleCount;
+    Pose start = chassis->getPose();
+    double forwardX = -std::sin(start.getTheta());
+    double forwardY = std::cos(start.getTheta());
+
+    uint32_t startTime = pros::millis();
+    uint32_t loopTime = startTime;
+    while (sampleCount < MAX_SAMPLES) {
+        uint32_t elapsed = pros::millis() - startTime;
+        if (params.maxTime != 0 && elapsed >= (uint32_t)params.maxTime) {
+            break;
+        }
+
+        double command = quasistatic ? params.rampRate * elapsed / 1000.0 : params.stepSpeed;
+        command = direction * std::min(command, 127.0);
+        chassis->setDriveSpeed(command);
+
+        Pose pose = chassis->getPose();
+        Pose velocity = chassis->getVelocity();
+        double position = (pose.getX() - start.getX()) * forwardX + (pose.getY() - start.getY()) * forwardY;
+        samples[sampleCount++] = {elapsed, (float)command, (float)position,
+                                  (float)(velocity.getX() * forwardX + velocity.getY() * forwardY)};
+
+        if (params.maxDistance != 0 && std::abs(position) >= params.maxDistance) {
+            break;
+        }
+        pros::Task::delay_until(&loopTime, samplePeriod);
+    }
+
+    chassis->stop();
+    pros::delay(params.restTime);
+    return first;
+}
+
+/**
+ * @brief Adds the samples of one test to the least squares sums. Accelerations are found by differencing neighbouring velocities.
+ * @param first The index of the test's first sample.
+ * @param last One past the index of the test's last sample.
+ * @param minVelocity Samples slower than this are skipped.
+ * @param sums The running sums.
+ */
+void Characterizer::accumulate(size_t first, size_t last, double minVelocity, FitSums &sums) const {
+    // Central differences need a sample on each side
+    for (size_t i = first + 1; i + 1 < last; i++) {
+        const CharacterizationSample &sample = samples[i];
+        double dt = (samples[i + 1].time - samples[i - 1].time) / 1000.0;
+        if (dt <= 0 || std::abs(sample.velocity) < minVelocity) {
+            continue;
+        }
+
+        double acceleration = (samples[i + 1].velocity - samples[i - 1].velocity) / dt;
+        std::array<double, 3> terms = {sample.velocity > 0 ? 1.0 : -1.0, sample.velocity, acceleration};
+        for (size_t row = 0; row < 3; row++) {
+            for (size_t column = 0; column < 3; column++) {
+                sums.xx[row][column] += terms[row] * terms[column];
+            }
+            sums.xy[row] += terms[row] * sample.command;
+        }
+        sums.yy += sample.command * sample.command;
+        sums.y += sample.command;
+        sums.count++;
+    }
+}
+
+/**
+ * @brief Converts a motor position to degrees of the motor's output shaft, whatever encoder units the motor uses.
+ * @param position The position, as returned by get_position.
+ * @param units The motor's encoder units.
+ * @param gearing The motor's gearing, which sets the number of counts per rotation.
+ * @return The position in degrees.
+ */
+static double toDegrees(double position, pros::v5::MotorUnits units, pros::v5::MotorGears gearing) {
+    switch (units) {
+        case pros::v5::MotorUnits::rotations:
+            return position * 360.0;
+        case pros::v5::MotorUnits::counts:
+            switch (gearing) {
+                case pros::v5::MotorGears::red:
+                    return position * 360.0 / 1800.0;
+                case pros::v5::MotorGears::blue:
+                    return position * 360.0 / 300.0;
+                default:
+                    return position * 360.0 / 900.0;
+            }
+        default:
+            return position;
+    }
+}
+
+/**
+ * @brief Spins the robot in place and finds the effective track width.
+ * @param params The characterization parameters.
+ * @return The effective track width in inches, or 0 if the robot didn't turn.
+ */
+double Characterizer::runTrackWidthTest(const CharacterizationParams &params) {
+    Drivetrain *drivetrain = chassis->drivetrain;
+    std::vector<pros::MotorGroup*> motors = drivetrain->getMotors();
+    // Only the groups that turn the robot travel around the track. Strafe wheels stay still and would pull the average down
+    motors.resize(std::min(motors.size(), drivetrain->getTurningMotorCount()));
+
+    // Average position of each motor group in degrees, read before and after spinning.
+    // Positions are converted from each motor's own units, so the user's encoder units are left alone
+    auto readPositions = [&motors]() {
+        std::array<double, Drivetrain::MAX_MOTOR_GROUPS> positions = {};
+        for (size_t i = 0; i < motors.size() && i < positions.size(); i++) {
+            std::vector<double> motorPositions = motors[i]->get_position_all();
+            std::vector<pros::v5::MotorUnits> units = motors[i]->get_encoder_units_all();
+            std::vector<pros::v5::MotorGears> gearing = motors[i]->get_gearing_all();
+            for (size_t j = 0; j < motorPositions.size() && j < units.size() && j < gearing.size(); j++) {
+                positions[i] += toDegrees(motorPositions[j], units[j], gearing[j]) / motorPositions.size();
+            }
+        }
+        return positions;
+    };
+
+    std::array<double, Drivetrain::MAX_MOTOR_GROUPS> startPositions = readPositions();
+    double startRotation = chassis->odometry->getRotationRadians();
+
+    chassis->setTurnSpeed(params.turnSpeed, SwingSide::NONE);
+    pros::delay(params.turnTime);
+    chassis->stop();
+    pros::delay(params.restTime);
+
+    std::array<double, Drivetrain::MAX_MOTOR_GROUPS> endPositions = readPositions();
+    double rotation = std::abs(chassis->odometry->getRotationRadians() - startRotation);
+    if (rotation < 0.1 || motors.empty()) {
+        return 0;
+    }
+
+    // Each wheel travels (track width / 2) * rotation while spinning in place, so the track width is twice the average travel over the rotation
+    double inchesPerDegree = drivetrain->getWheelDiameter() * M_PI * drivetrain->getGearRatio() / 360.0;
+    double travel = 0;
+    for (size_t i = 0; i < motors.size() && i < Drivetrain::MAX_MOTOR_GROUPS; i++) {
+        travel += std::abs(endPositions[i] - startPositions[i]) * inchesPerDegree;
+    }
+    travel /= std::min(motors.size(), Drivetrain::MAX_MOTOR_GROUPS);
+    return 2 * travel / rotation;
+}
+
+/**
+ * @brief Runs every test and fits the results. Blocks until done, which takes about half a minute. Don't run other motions at the same time.
+ * @param params The characterization parameters.
+ * @return The fitted model and track width.
+ */
+CharacterizationResult Characterizer::run(CharacterizationParams params) {
+    CharacterizationResult result;
+    if (chassis == nullptr || chassis->drivetrain == nullptr || chassis->odometry == nullptr) {
+        return result;
+    }
+    if (!chassis->tracking) {
+        chassis->startTracking();
+    }
+
+    // Quasistatic and dynamic tests in each direction. Driving forwards then backwards returns the robot close to where it started
+    sampleCount = 0;
+    FitSums sums;
+    const std::array<std::array<double, 2>, 4> tests = {{{1, 1}, {-1, 1}, {1, 0}, {-1, 0}}};
+    for (const std::array<double, 2> &test : tests) {
+        size_t first = runDriveTest(test[0], test[1] != 0, params);
+        accumulate(first, sampleCount, params.minVelocity, sums);
+    }
+
+    // Solve the normal equations with Gaussian elimination and partial pivoting
+    std::array<std::array<double, 4>, 3> matrix;
+    for (size_t row = 0; row < 3; row++) {
+        for (size_t column = 0; column < 3; column++) {
+            matrix[row][column] = sums.xx[row][column];
+        }
+        matrix[row][3] = sums.xy[row];
+    }
+    bool solved = sums.count > 3;
+    for (size_t pivot = 0; pivot < 3 && solved; pivot++) {
+        size_t best = pivot;
+        for (size_t row = pivot + 1; row < 3; row++) {
+            if (std::abs(matrix[row][pivot]) > std::abs(matrix[best][pivot])) {
+                best = row;
+            }
+        }
+        std::swap(matrix[pivot], matrix[best]);
+        if (std::abs(matrix[pivot][pivot]) < 1e-9) {
+            solved = false;
+            break;
+        }
+        for (size_t row = 0; row < 3; row++) {
+            if (row == pivot) {
+                continue;
+            }
+            double factor = matrix[row][pivot] / matrix[pivot][pivot];
+            for (size_t column = pivot; column < 4; column++) {
+                matrix[row][column] -= factor * matrix[pivot][column];
+            }
+        }
+    }
+
+    if (solved) {
+        std::array<double, 3> gains;
+        for (size_t row = 0; row < 3; row++) {
+            gains[row] = matrix[row][3] / matrix[row][row];
+        }
+
+        // R^2 = 1 - residual sum of squares / total sum of squares, both expanded in terms of the sums
+        double residual = sums.yy;
+        for (size_t row = 0; row < 3; row++) {
+            residual -= 2 * gains[row] * sums.xy[row];
+            for (size_t column = 0; column < 3; column++) {
+                residual += gains[row] * gains[column] * sums.xx[row][column];
+            }
+        }
+        double total = sums.yy - sums.y * sums.y / sums.count;
+
+        result.feedforward = Feedforward(gains[0], gains[1], gains[2]);
+        result.rSquared = total > 0 ? 1 - residual / total : 0;
+        result.fittedSamples = sums.count;
+        result.valid = true;
+    }
+
+    if (params.turnSpeed != 0) {
+        result.trackWidth = runTrackWidthTest(params);
+    }
+
+    if (params.apply) {
+        if (result.valid) {
+            chassis->setFeedforward(result.feedforward);
+        }
+        if (result.trackWidth > 0) {
+            chassis->drivetrain->setWheelTrackWidth(result.trackWidth);
+        }
+    }
+
+    return result;
+}
@@ -1,50 +1,19 @@
 #include "lib/chassis.hpp"
+#include "util/angle.hpp"
+#include <algorithm>
 #include <cmath>
+#include <utility>
 
-/**
- * @brief Scales an input value based on the selected input scaling method.
- * @param input The input value to scale (-127 to 127). 
- * @return The scaled input value.
- */
-double Chassis::scaleInput(int input) {
-    double normalizedInput = (double)input / 127.0;
-    double scaledInput = 0.0;
-
-    bool isNegative = normalizedInput < 0;
-
-    switch (inputScale) {
-        case LINEAR:
-            scaledInput = normalizedInput;
-            break;
-        case CUBIC:
-            scaledInput = normalizedInput * normalizedInput * normalizedInput;
-            break;
-        case QUINTIC:
-            scaledInput = normalizedInput * normalizedInput * normalizedInput * normalizedInput * normalizedInput;
-            break;
-        case SIN:
-            scaledInput = sin((normalizedInput * M_PI) / 2);
-            break;
-        case SINSQUARED:
-            scaledInput = sin((normalizedInput * M_PI) / 2);
-            scaledInput = scaledInput * scaledInput;
-            break;
-        case TAN:
-            scaledInput = tan(normalizedInput);
-            break;
-        case XTAN:
-            scaledInput = normalizedInput * tan(normalizedInput);
-            break;
-        default:
-            scaledInput = normalizedInput;
-    }
-
-    if (isNegative && scaledInput > 0) {
-        scaledInput = -scaledInput;
-    }
-
-    return scaledInput * 127.0;
-}
+// The built-in curves are computed at compile time
+static constexpr InputCurve BUILT_IN_CURVES[] = {
+    InputCurve::linear(),
+    InputCurve::cubic(),
+    InputCurve::quintic(),
+    InputCurve::sine(),
+    InputCurve::sineSquared(),
+    InputCurve::tangent(),
+    InputCurve::xTangent()
+};
 
 /**
  * @brief Sets the input scaling method. The input scaling affects how joystick inputs are translated to motor speeds.
@@ -68,7 +37,26 @@ double Chassis::scaleInput(int input) {
  * @param scale The input scaling method to set.
  */
 void Chassis::setInputScale(InputScale scale) {
-    inputScale = scale;
+    if (scale < LINEAR || scale > XTAN) {
+        return;
+    }
+    inputCurve = BUILT_IN_CURVES[scale];
+}
+
+/**
+ * @brief Sets a custom input curve, such as InputCurve::exponential or InputCurve::piecewiseLinear.
+ * @param curve The input curve to use.
+ */
+void Chassis::setInputCurve(const InputCurve &curve) {
+    inputCurve = curve;
+}
+
+/**
+ * @brief Sets the drivetrain feedforward model used by velocity-controlled motions.
+ * @param feedforward The feedforward model.
+ */
+void Chassis::setFeedforward(Feedforward feedforward) {
+    this->feedforward = feedforward;
 }
 
 /**
@@ -79,6 +67,7 @@ void Chassis::reset() {
         odometry->reset();
     }
     if (drivetrain) {
+        drivetrain->resetLimiter();
         drivetrain->setMotorSpeeds({0, 0, 0, 0, 0});
     }
     if (!tracking) {
@@ -91,10 +80,280 @@ void Chassis::reset() {
  */
 void Chassis::stop() {
     if (drivetrain) {
+        // Stop outright instead of ramping down, since nothing keeps sending commands after this
+        drivetrain->resetLimiter();
         drivetrain->setMotorSpeeds({0, 0, 0, 0, 0});
     }
 }
 
+/**
+ * @brief Starts the motion task if it is not already running.
+ * The task sleeps until notified that a motion was queued, then runs queued motions until the queue is empty.
+ */
+void Chassis::startMotionTask() {
+    pros::Task task([this] {
+        while (true) {
+            pros::Task::notify_take(true, TIMEOUT_MAX);
+
+            while (true) {
+                motionMutex.take();
+                if (queueSize == 0) {
+                    inMotion = false;
+                    notifyWaiters(true);
+                    motionMutex.give();
+                    break;
+                }
+                std::function<void()> motion = std::move(motionQueue[queueStart]);
+                motionQueue[queueStart] = nullptr;
+                queueStart = (queueStart + 1) % MAX_QUEUED_MOTIONS;
+                queueSize--;
+                cancelRequested = false;
+                motionDistance = 0;
+                motionRunning = true;
+                motionsStarted++;
+                motionMutex.give();
+
+                motion();
+
+                motionMutex.take();
+                motionRunning = false;
+                motionsFinished++;
+                notifyWaiters(true);
+                motionMutex.give();
+            }
+        }
+    });
+    motionTask = (pros::task_t)task;
+}
+
+/**
+ * @brief Wakes waiting tasks. Must be called while holding motionMutex.
+ * @param finished True if a motion just finished, which wakes every waiter. Otherwise only waiters whose distance has been reached are woken.
+ */
+void Chassis::notifyWaiters(bool finished) {
+    for (MotionWaiter &waiter : waiters) {
+        if (waiter.task && (finished || (waiter.distance > 0 && motionDistance >= waiter.distance))) {
+            pros::c::task_notify(waiter.task);
+        }
+    }
+}
+
+/**
+ * @brief Adds the distance the robot moved to the running motion's progress and wakes any tasks waiting on it.
+ * @param distance The distance moved since the last update (inches).
+ */
+void Chassis::updateMotionDistance(double distance) {
+    if (!motionRunning) {
+        return;
+    }
+    motionMutex.take();
+    motionDistance += distance;
+    notifyWaiters(false);
+    motionMutex.give();
+}
+
+/**
+ * @brief Blocks the calling task until a motion has finished or, if distance is set, the running motion has traveled that far.
+ * @param distance The distance in inches. Set to 0 to wait until the motion has finished.
+ * @param allMotions If true, waits until every queued motion has finished instead of only the current one.
+ */
+void Chassis::waitForMotion(double distance, bool allMotions) {
+    motionMutex.take();
+
+    // Wait on the running motion, or the next one to start if none is running
+    uint32_t targetMotion = motionRunning ? motionsStarted : motionsStarted + 1;
+
+    // Register before checking, so a notification sent after the check isn't missed
+    MotionWaiter *slot = nullptr;
+    for (MotionWaiter &waiter : waiters) {
+        if (!waiter.task) {
+            slot = &waiter;
+            slot->task = pros::c::task_get_current();
+            slot->distance = distance;
+            break;
+        }
+    }
+
+    while (inMotion) {
+        bool done = !allMotions && (motionsFinished >= targetMotion ||
+                    (distance > 0 && motionsStarted == targetMotion && motionDistance >= distance));
+        if (done) {
+            break;
+        }
+
+        motionMutex.give();
+        // Every waiter slot is taken, fall back to checking periodically
+        pros::Task::notify_take(true, slot ? TIMEOUT_MAX : 10);
+        motionMutex.take();
+    }
+
+    if (slot) {
+        slot->task = nullptr;
+    }
+    motionMutex.give();
+}
+
+/**
+ * @brief Blocks the calling task until every queued motion has finished.
+ */
+void Chassis::waitUntilDone() {
+    waitForMotion(0, true);
+}
+
+/**
+ * @brief Blocks the calling task until the running motion has traveled a distance, or has finished.
+ * If no motion has started yet, waits on the next queued motion. Returns immediately if nothing is queued.
+ * @param distance The distance traveled since the motion started (inches).
+ */
+void Chassis::waitUntilDistance(double distance) {
+    waitForMotion(std::max(distance, 0.0), false);
+}
+
+/**
+ * @brief Ends the running motion early and clears every queued motion.
+ */
+void Chassis::cancel() {
+    motionMutex.take();
+    for (size_t i = 0; i < queueSize; i++) {
+        motionQueue[(queueStart + i) % MAX_QUEUED_MOTIONS] = nullptr;
+    }
+    queueSize = 0;
+    if (motionRunning) {
+        cancelRequested = true;
+    } else {
+        inMotion = false;
+        notifyWaiters(true);
+    }
+    motionMutex.give();
+}
+
+/**
+ * @brief Queues a motion to run on the motion task once all previously queued motions have finished.
+ * @param motion The motion loop to run. It should exit early once cancelRequested is set.
+ * @param async If true, this function returns as soon as the motion is queued. Otherwise it blocks until the motion has finished.
+ */
+void Chassis::runMotion(std::function<void()> motion, bool async) {
+    motionMutex.take();
+    if (!motionTask) {
+        startMotionTask();
+    }
+
+    // Wait for space if the queue is full
+    while (queueSize == MAX_QUEUED_MOTIONS) {
+        motionMutex.give();
+        waitForMotion(0, false);
+        motionMutex.take();
+    }
+
+    motionQueue[(queueStart + queueSize) % MAX_QUEUED_MOTIONS] = std::move(motion);
+    queueSize++;
+    inMotion = true;
+    motionMutex.give();
+
+    pros::c::task_notify(motionTask);
+
+    if (!async) {
+        waitUntilDone();
+    }
+}
+
+/**
+ * @brief The control loop shared by all turns. Blocks until the turn has settled or timed out.
+ * @param targetHeading Returns the heading to turn to (in radians). Evaluated every iteration.
+ * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+ * @param params The turn parameters.
+ */
+void Chassis::turnLoop(std::function<double()> targetHeading, int timeout, TurnParams params) {
+    ExitCondition smallExit(turnPID->getSmallErrorRange(), params.smallErrorTime);
+    ExitCondition largeExit(turnPID->getLargeErrorRange(), params.largeErrorTime);
+    turnPID->reset();
+
+    TurnResult result;
+    int startTime = pros::millis();
+    double initialError = 0;
+    bool firstLoop = true;
+    bool exitedEarly = false;
+
+    while (!cancelRequested) {
+        // Error in degrees, wrapped so the robot always takes the shorter way around
+        double error = radToDeg(angleError(targetHeading(), getPose().getTheta()));
+        if (firstLoop) {
+            initialError = error;
+            firstLoop = false;
+        }
+
+        // Overshoot is any error with the opposite sign of the initial error
+        if (initialError * error < 0) {
+            result.overshoot = std::max(result.overshoot, std::abs(error));
+        }
+        result.finalError = error;
+
+        // Chained turns hand over to the next motion while still turning
+        if ((params.earlyExitRange != 0 && std::abs(error) < params.earlyExitRange) ||
+            (params.minSpeed != 0 && initialError * error < 0)) {
+            exitedEarly = true;
+            break;
+        }
+
+        if (smallExit.update(error) || largeExit.update(error)) {
+            break;
+        }
+        if (timeout != 0 && (int)pros::millis() - startTime >= timeout) {
+            result.timedOut = true;
+            break;
+        }
+
+        double output = std::clamp(turnPID->calculate(0, error), -params.maxSpeed, params.maxSpeed);
+        if (params.minSpeed != 0 && std::abs(output) < params.minSpeed) {
+            output = error < 0 ? -params.minSpeed : params.minSpeed;
+        }
+        setTurnSpeed(output, params.lockedSide);
+
+        pros::delay(10);
+    }
+
+    if (!exitedEarly) {
+        stop();
+    }
+
+    result.settleTime = pros::millis() - startTime;
+    lastTurnResult = result;
+}
+
+/**
+ * @brief Calculates the lookahead distance for a target speed.
+ * @param velocity The target motor speed (0 - 127).
+ * @param params The pure pursuit parameters.
+ * @return The lookahead distance in inches, between params.minLookahead and params.maxLookahead.
+ */
+double Chassis::getLookahead(double velocity, PurePursuitParams params) {
+    double speedRatio = std::clamp(std::abs(velocity) / params.maxSpeed, 0.0, 1.0);
+    return params.minLookahead + (params.maxLookahead - params.minLookahead) * speedRatio;
+}
+
+/**
+ * @brief Turn the robot to face a point on the field using PID control.
+ * @param x The x-coordinate of the point (in inches).
+ * @param y The y-coordinate of the point (in inches).
+ * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+ * @param params The turn parameters. Set forwards to false to face the point with the back of the robot.
+ * @param async If true, the turn runs in the background and this function returns immediately.
+ */
+void Chassis::turnToPoint(double x, double y, int timeout, TurnParams params, bool async) {
+    if (!drivetrain || !odometry || !turnPID) {
+        return;
+    }
+
+    Pose point(x, y, 0);
+    double offset = params.forwards ? 0.0 : M_PI;
+
+    runMotion([this, point, offset, timeout, params] {
+        turnLoop([this, point, offset] {
+            return getPose().headingTo(point) + offset;
+        }, timeout, params);
+    }, async);
+}
+
 /**
  * @brief Get the robot's current pose (position and orientation).
  * @return The robot's current pose.
@@ -103,6 +362,50 @@ Pose Chassis::getPose() const {
     return *pose; 
 }
 
+/**
+ * @brief Publishes the latest heading for other tasks. Only called by the tracking task.
+ * @param heading The heading in radians.
+ * @param rate The yaw rate in radians per second.
+ */
+void Chassis::publishHeading(double heading, double rate) {
+    uint32_t sequence = headingSequence.load(std::memory_order_relaxed);
+    headingSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    headingSample.heading = heading;
+    headingSample.rate = rate;
+    headingSample.timestamp = pros::micros();
+    headingSequence.store(sequence + 2, std::memory_order_release);
+}
+
+/**
+ * @brief Get the last heading published by the tracking task, without any device calls.
+ * @return The heading, yaw rate, and when the heading was measured.
+ */
+HeadingSample Chassis::getHeadingSample() const {
+    HeadingSample sample;
+    uint32_t sequence;
+    do {
+        sequence = headingSequence.load(std::memory_order_acquire);
+        sample = headingSample;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) || sequence != headingSequence.load(std::memory_order_relaxed));
+    return sample;
+}
+
+/**
+ * @brief Get the heading predicted for the current time, extrapolating the last published heading with the yaw rate.
+ * This makes up for the time since the tracking task last ran, without any device calls.
+ * @return The predicted heading in radians.
+ */
+double Chassis::getPredictedHeading() const {
+    // Don't extrapolate far past a stale sample, the yaw rate may have changed
+    const uint32_t maxExtrapolation = 50000; // in microseconds
+
+    HeadingSample sample = getHeadingSample();
+    uint32_t age = std::min((uint32_t)pros::micros() - sample.timestamp, maxExtrapolation);
+    return sample.heading + sample.rate * age / 1e6;
+}
+
 /**
  * @brief Set the robot's current pose (position and orientation).
  * @param newPose The new pose to set.
@@ -159,8 +462,9 @@ void Chassis::trackPosition() {
 
     Pose formerPosition = getPose();
 
-    // Calculate the change in orientation
-    double delTheta = odometry->getRotationRadians() - formerPosition.getTheta();
+    // Calculate the change in orientation, from the IMU reading taken with the wheel readings
+    double rotation = currentPose[3];
+    double delTheta = rotation - formerPosition.getTheta();
     
     // Calculate local displacement vector
     double deltaDl[2]; 
@@ -180,5 +484,5 @@ void Chassis::trackPosition() {
     deltaD = deltaD.rotate(-1*thetaM);
 
     // Update the position
-    setPose(formerPosition.getX() + deltaD.getX(), formerPosition.getY() + deltaD.getY(), odometry->getRotationRadians());
+    setPose(formerPosition.getX() + deltaD.getX(), formerPosition.getY() + deltaD.getY(), rotation);
 }
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cmath>
 #include "lib/differentialchassis.hpp"
+#include "util/angle.hpp"
 #include "pros/rtos.hpp"
 
 /**
@@ -27,19 +29,325 @@ void DifferentialChassis::tank(int leftY, int rightY) {
 }
 
 /**
- * @brief Move the robot to a specific position using PID control.
+ * @brief Move the robot to a specific pose using a boomerang controller.
+ * The robot chases a carrot point placed behind the target along its heading, which curves the path so the robot arrives facing the target heading.
+ * The lateral PID drives the distance to the carrot point and the turn PID drives the heading error.
+ * 
  * @param targetPose The target pose to move to.
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The motion parameters.
+ * @param async If true, the motion runs in the background and this function returns immediately.
  */
-void DifferentialChassis::moveToPose(Pose targetPose) {
-    // TODO: Implement MoveTo for DifferentialChassis
+void DifferentialChassis::moveToPose(Pose targetPose, int timeout, MoveToPoseParams params, bool async) {
+    if (!drivetrain || !odometry || !lateralPID || !turnPID) {
+        return;
+    }
+
+    runMotion([this, targetPose, timeout, params] {
+        moveToPoseLoop(targetPose, timeout, params);
+    }, async);
+}
+
+/**
+ * @brief The control loop behind moveToPose. Blocks until the motion has finished.
+ * 
+ * @param targetPose The target pose to move to.
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The motion parameters.
+ */
+void DifferentialChassis::moveToPoseLoop(Pose targetPose, int timeout, MoveToPoseParams params) {
+    // Within this distance (in inches) the carrot point is dropped and the robot settles on the target itself
+    const double closeDistance = 7.5;
+
+    ExitCondition smallExit(lateralPID->getSmallErrorRange(), params.smallErrorTime);
+    ExitCondition largeExit(lateralPID->getLargeErrorRange(), params.largeErrorTime);
+    lateralPID->reset();
+    turnPID->reset();
+
+    // Driving backwards is handled by steering with the back of the robot
+    double direction = params.forwards ? 1.0 : -1.0;
+    double travelOffset = params.forwards ? 0.0 : M_PI;
+
+    // Heading of travel when arriving at the target
+    double targetTravelHeading = targetPose.getTheta() + travelOffset;
+
+    bool close = false;
+    bool exitedEarly = false;
+    int startTime = pros::millis();
+
+    while (!cancelRequested && (timeout == 0 || (int)pros::millis() - startTime < timeout)) {
+        Pose currentPose = getPose();
+        double travelHeading = currentPose.getTheta() + travelOffset;
+        double distance = currentPose.distanceTo(targetPose);
+
+        // Once close, stay close so the carrot point can't jump around the target
+        if (distance < closeDistance) {
+            close = true;
+        }
+
+        // Place the carrot point behind the target along the direction of travel
+        Pose carrot = targetPose;
+        if (!close) {
+            double leadDistance = distance * params.lead;
+            carrot = Pose(targetPose.getX() + leadDistance * sin(targetTravelHeading),
+                          targetPose.getY() - leadDistance * cos(targetTravelHeading),
+                          targetPose.getTheta());
+        }
+
+        // Heading error towards the carrot, or towards the final heading once close
+        double carrotError = angleError(currentPose.headingTo(carrot), travelHeading);
+        double angularError = close ? angleError(targetTravelHeading, travelHeading) : carrotError;
+
+        // Distance to the carrot projected onto the direction of travel
+        double lateralError = currentPose.distanceTo(carrot) * cos(carrotError);
+
+        double lateralOut = lateralPID->calculate(0, lateralError);
+        double angularOut = turnPID->calculate(0, radToDeg(angularError));
+
+        // Chained motions hand over to the next motion while still moving, either once in range or once the target is behind the robot
+        if ((params.earlyExitRange != 0 && distance < params.earlyExitRange) ||
+            (params.minSpeed != 0 && close && lateralError < 0)) {
+            exitedEarly = true;
+            break;
+        }
+
+        // Only settle once the carrot point has been dropped
+        if (close && (smallExit.update(lateralError) || largeExit.update(lateralError))) {
+            break;
+        }
+
+        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
+        if (params.minSpeed != 0) {
+            lateralOut = std::max(lateralOut, params.minSpeed);
+        }
+
+        if (!close) {
+            // Don't reverse away from the carrot while it is still ahead of the robot
+            lateralOut = std::max(lateralOut, 0.0);
+
+            // Slow down on tight curves. The radius is that of the arc tangent to the robot's heading that passes through the carrot
+            double sinError = std::abs(sin(carrotError));
+            if (params.horizontalDrift != 0 && sinError > 0) {
+                double radius = currentPose.distanceTo(carrot) / (2 * sinError);
+                double maxCurveSpeed = sqrt(params.horizontalDrift * radius);
+                lateralOut = std::clamp(lateralOut, -maxCurveSpeed, maxCurveSpeed);
+            }
+        }
+
+        // Desaturate by scaling both outputs together, which keeps the curvature of the arc
+        double ratio = std::max(std::abs(lateralOut + angularOut), std::abs(lateralOut - angularOut)) / params.maxSpeed;
+        if (ratio > 1) {
+            lateralOut /= ratio;
+            angularOut /= ratio;
+        }
+
+        double leftPower = direction * lateralOut + angularOut;
+        double rightPower = direction * lateralOut - angularOut;
+        drivetrain->setMotorSpeeds({leftPower, rightPower}, MotorCommand::SPEED);
+
+        pros::delay(10);
+    }
+
+    if (!exitedEarly) {
+        stop();
+    }
+}
+
+/**
+ * @brief Follow a path of waypoints using pure pursuit.
+ * The robot drives the arc that passes through the lookahead point.
+ * 
+ * @param path The waypoints to follow, spaced closely together (a few inches apart).
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The pure pursuit parameters.
+ * @param async If true, the motion runs in the background and this function returns immediately.
+ */
+void DifferentialChassis::followPath(std::vector<Waypoint> path, int timeout, PurePursuitParams params, bool async) {
+    if (!drivetrain || !odometry || path.empty()) {
+        return;
+    }
+
+    runMotion([this, path, timeout, params] {
+        followPathLoop(path, timeout, params);
+    }, async);
+}
+
+/**
+ * @brief The control loop behind followPath. Blocks until the path has finished.
+ * @param path The waypoints to follow.
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The pure pursuit parameters.
+ */
+void DifferentialChassis::followPathLoop(std::vector<Waypoint> path, int timeout, PurePursuitParams params) {
+    PurePursuit follower(path);
+    double direction = params.forwards ? 1.0 : -1.0;
+    double travelOffset = params.forwards ? 0.0 : M_PI;
+    double trackWidth = drivetrain->getWheelTrackWidth();
+
+    double velocity = path[0].velocity;
+    int startTime = pros::millis();
+
+    while (!cancelRequested && (timeout == 0 || (int)pros::millis() - startTime < timeout)) {
+        Pose currentPose = getPose();
+
+        // The lookahead distance follows the speed of the previous iteration
+        follower.update(currentPose, getLookahead(velocity, params));
+        if (follower.isFinished(currentPose, params.endDistance)) {
+            break;
+        }
+
+        velocity = std::min(follower.getClosest().velocity, params.maxSpeed);
+        Waypoint lookahead = follower.getLookahead();
+        Pose lookaheadPose(lookahead.x, lookahead.y, 0);
+
+        // Curvature of the arc tangent to the robot's heading that passes through the lookahead point
+        double distance = currentPose.distanceTo(lookaheadPose);
+        double headingError = angleError(currentPose.headingTo(lookaheadPose), currentPose.getTheta() + travelOffset);
+        double curvature = distance == 0 ? 0 : 2 * sin(headingError) / distance;
+
+        double leftPower = direction * velocity + velocity * curvature * trackWidth / 2;
+        double rightPower = direction * velocity - velocity * curvature * trackWidth / 2;
+
+        // Desaturate by scaling both sides together, which keeps the curvature of the arc
+        double ratio = std::max(std::abs(leftPower), std::abs(rightPower)) / params.maxSpeed;
+        if (ratio > 1) {
+            leftPower /= ratio;
+            rightPower /= ratio;
+        }
+
+        drivetrain->setMotorSpeeds({leftPower, rightPower}, MotorCommand::SPEED);
+
+        pros::delay(10);
+    }
+
+    stop();
+}
+
+/**
+ * @brief Follow a time-parameterized trajectory using a RAMSETE controller.
+ * The corrected velocities are converted to wheel velocities and sent to each side through the feedforward model,
+ * plus optional per-side velocity feedback. The robot's pose should match the trajectory's start pose.
+ * 
+ * @param trajectory The trajectory to follow. It must stay alive until the motion has finished.
+ * @param params The RAMSETE parameters.
+ * @param async If true, the motion runs in the background and this function returns immediately.
+ */
+void DifferentialChassis::followTrajectory(const Trajectory &trajectory, RamseteParams params, bool async) {
+    if (!drivetrain || !odometry || !trajectory.isValid()) {
+        return;
+    }
+
+    const Trajectory *trajectoryPtr = &trajectory;
+    runMotion([this, trajectoryPtr, params] {
+        followTrajectoryLoop(trajectoryPtr, params);
+    }, async);
+}
+
+/**
+ * @brief The control loop behind followTrajectory. Blocks until the trajectory has finished.
+ * @param trajectory The trajectory to follow.
+ * @param params The RAMSETE parameters.
+ */
+void DifferentialChassis::followTrajectoryLoop(const Trajectory *trajectory, RamseteParams params) {
+    Ramsete controller(params.b, params.zeta);
+    double trackWidth = drivetrain->getWheelTrackWidth();
+
+    uint32_t startTime = pros::millis();
+    uint32_t loopTime = startTime;
+
+    while (!cancelRequested) {
+        double time = (pros::millis() - startTime) / 1000.0;
+        if (time > trajectory->getDuration()) {
+            break;
+        }
+
+        TrajectoryPoint reference = trajectory->sample(time);
+        ChassisVelocity velocity = controller.calculate(getPose(), reference.pose, reference.velocity, reference.angularVelocity);
+
+        // A positive angular velocity increases the heading, which means the left side goes faster
+        double leftVelocity = velocity.linear + velocity.angular * trackWidth / 2;
+        double rightVelocity = velocity.linear - velocity.angular * trackWidth / 2;
+
+        double leftPower = feedforward.calculate(leftVelocity, reference.acceleration);
+        double rightPower = feedforward.calculate(rightVelocity, reference.acceleration);
+
+        if (params.kP != 0) {
+            std::array<double, 2> measured = getSideVelocities();
+            leftPower += params.kP * (leftVelocity - measured[0]);
+            rightPower += params.kP * (rightVelocity - measured[1]);
+        }
+
+        leftPower = std::clamp(leftPower, -127.0, 127.0);
+        rightPower = std::clamp(rightPower, -127.0, 127.0);
+        drivetrain->setMotorSpeeds({leftPower, rightPower}, MotorCommand::SPEED);
+
+        pros::Task::delay_until(&loopTime, 10);
+    }
+
+    stop();
+}
+
+/**
+ * @brief Get the measured velocity of each side of the drivetrain.
+ * @return The left and right velocities in inches per second.
+ */
+std::array<double, 2> DifferentialChassis::getSideVelocities() {
+    std::array<pros::MotorGroup*, Drivetrain::MAX_MOTOR_GROUPS> groups;
+    size_t groupCount = drivetrain->getMotors(groups);
+    double inchesPerRevolution = drivetrain->getWheelDiameter() * M_PI * drivetrain->getGearRatio();
+
+    std::array<double, 2> sides = {0, 0};
+    for (size_t side = 0; side < 2 && side < groupCount; side++) {
+        int motorCount = groups[side]->size();
+        if (motorCount <= 0) {
+            continue;
+        }
+        double averageRPM = 0;
+        for (int motor = 0; motor < motorCount; motor++) {
+            averageRPM += groups[side]->get_actual_velocity(motor);
+        }
+        averageRPM /= motorCount;
+        sides[side] = averageRPM / 60.0 * inchesPerRevolution;
+    }
+    return sides;
 }
 
 /**
  * @brief Turn the robot to a specific angle using PID control.
- * 0 Degrees is facing "forward" from the starting orientation.
+ * 0 Degrees is facing "forward" from the starting orientation. The robot turns whichever way is shorter.
  * 
  * @param targetAngle The target angle to turn to (in degrees).
+ * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+ * @param params The turn parameters. Set lockedSide for a swing turn.
+ * @param async If true, the turn runs in the background and this function returns immediately.
+ */
+void DifferentialChassis::turnAngle(double targetAngle, int timeout, TurnParams params, bool async) {
+    if (!drivetrain || !odometry || !turnPID) {
+        return;
+    }
+
+    double targetHeading = degToRad(targetAngle);
+    runMotion([this, targetHeading, timeout, params] {
+        turnLoop([targetHeading] { return targetHeading; }, timeout, params);
+    }, async);
+}
+
+/**
+ * @brief Applies a turning speed to the drivetrain. Positive speeds increase the heading.
+ * @param speed The turning speed (-127 to 127).
+ * @param lockedSide The side of the robot to hold still, or NONE to turn in place.
+ */
+void DifferentialChassis::setTurnSpeed(double speed, SwingSide lockedSide) {
+    double leftSpeed = lockedSide == SwingSide::LEFT ? 0 : speed;
+    double rightSpeed = lockedSide == SwingSide::RIGHT ? 0 : -speed;
+    drivetrain->setMotorSpeeds({leftSpeed, rightSpeed}, MotorCommand::SPEED);
+}
+
+/**
+ * @brief Applies a straight driving speed to the drivetrain. Positive speeds drive forwards.
+ * @param speed The driving speed (-127 to 127).
  */
-void DifferentialChassis::turnAngle(double targetAngle) {
-    // TODO: Implement TurnAngle for DifferentialChassis
+void DifferentialChassis::setDriveSpeed(double speed) {
+    drivetrain->setMotorSpeeds({speed, speed}, MotorCommand::SPEED);
 }
@@ -104,15 +104,36 @@ std::vector<pros::MotorGroup*> DifferentialDrivetrain::getMotors() {
 }
 
 /**
- * Sets the speeds of the motors based on the speeds given.
- * The first speed is assigned to the left motors.
- * The second speed is assigned to the right motors.
+ * Fills an array with the motor groups on this drivetrain, in the order of getMotors(), without allocating.
  * 
- * @param speeds An array containing the speeds for the left and right motors.
+ * @param groups The array to fill.
+ * @return The number of motor groups.
  */
-void DifferentialDrivetrain::setMotorSpeeds(std::initializer_list<int> speeds) {
-    leftMotors->move(speeds.begin()[0]);
-    rightMotors->move(speeds.begin()[1]);
+size_t DifferentialDrivetrain::getMotors(std::array<pros::MotorGroup*, MAX_MOTOR_GROUPS> &groups) {
+    groups[0] = leftMotors;
+    groups[1] = rightMotors;
+    return 2;
 }
 
+/**
+ * Returns how many motor groups, from the start of getMotors(), turn the robot in place.
+ * Both sides turn the robot.
+ */
+size_t DifferentialDrivetrain::getTurningMotorCount() {
+    return 2;
+}
 
+/**
+ * Sends a command to every motor group.
+ * The first command is sent to the left motors.
+ * The second command is sent to the right motors.
+ * The change in each output is limited by the drivetrain's acceleration limits.
+ * 
+ * @param commands An array containing the commands for the left and right motors.
+ * @param mode How the commands are sent: motor speed, voltage, or closed-loop velocity.
+ */
+void DifferentialDrivetrain::setMotorSpeeds(const std::array<double, MAX_MOTOR_GROUPS> &commands, MotorCommand mode) {
+    updateLimiter();
+    sendCommand(0, leftMotors, commands[0], mode);
+    sendCommand(1, rightMotors, commands[1], mode);
+}
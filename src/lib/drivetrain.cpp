@@ -0,0 +1,119 @@
+#include "lib/drivetrain.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * Works out how much each motor group's output may change this update,
+ * from the time since the last update and the robot's tilt.
+ */
+void Drivetrain::updateLimiter() {
+    // Don't let a long pause between commands allow one big jump
+    const double maxStepTime = 0.05; // in seconds
+
+    uint32_t now = pros::millis();
+    double dt = std::min((now - lastLimitTime) / 1000.0, maxStepTime);
+    lastLimitTime = now;
+
+    double scale = 1;
+    if (tipImu != nullptr && tipMaxAngle > tipStartAngle) {
+        double tilt = std::max(std::abs(tipImu->get_pitch()), std::abs(tipImu->get_roll()));
+        // Readings fail as PROS_ERR_F (infinity), so a disconnected IMU leaves the limits unchanged
+        if (std::isfinite(tilt)) {
+            double tipping = std::clamp((tilt - tipStartAngle) / (tipMaxAngle - tipStartAngle), 0.0, 1.0);
+            scale = 1 - tipping * (1 - tipMinScale);
+        }
+    }
+
+    accelerationStep = maxAcceleration * scale * dt;
+    decelerationStep = maxDeceleration * scale * dt;
+}
+
+/**
+ * Sends a command to a motor group, after limiting how fast its output changes.
+ *
+ * @param index The motor group's index in getMotors(), which selects its limiter state.
+ * @param motors The motor group.
+ * @param command The command value, in the units of the mode.
+ * @param mode How the command is sent.
+ */
+void Drivetrain::sendCommand(size_t index, pros::MotorGroup *motors, double command, MotorCommand mode) {
+    // Convert the command to motor speed (-127 to 127), so the limits mean the same thing in every mode
+    double unitsPerSpeed = 1;
+    switch (mode) {
+        case MotorCommand::SPEED:
+            break;
+        case MotorCommand::VOLTAGE:
+            unitsPerSpeed = 12000.0 / 127.0;
+            break;
+        case MotorCommand::VELOCITY:
+            switch (motors->get_gearing()) {
+                case pros::v5::MotorGears::red:
+                    unitsPerSpeed = 100.0 / 127.0;
+                    break;
+                case pros::v5::MotorGears::blue:
+                    unitsPerSpeed = 600.0 / 127.0;
+                    break;
+                default:
+                    unitsPerSpeed = 200.0 / 127.0;
+                    break;
+            }
+            break;
+    }
+
+    // Mixed commands such as arcade's leftY + rightX can ask for more than full speed. The motors can't go faster,
+    // so the limiter must not ramp past full speed either, or releasing the stick would have to ramp back down first
+    double speed = std::clamp(command / unitsPerSpeed, -127.0, 127.0);
+    double previous = limitedSpeeds[index];
+    bool accelerating = std::abs(speed) > std::abs(previous) && (previous == 0 || (speed > 0) == (previous > 0));
+    if (accelerating && maxAcceleration > 0) {
+        speed = std::clamp(speed, previous - accelerationStep, previous + accelerationStep);
+    } else if (!accelerating && maxDeceleration > 0) {
+        speed = std::clamp(speed, previous - decelerationStep, previous + decelerationStep);
+    }
+    limitedSpeeds[index] = speed;
+
+    command = speed * unitsPerSpeed;
+    switch (mode) {
+        case MotorCommand::SPEED:
+            motors->move_voltage((int32_t)std::lround(command * 12000.0 / 127.0));
+            break;
+        case MotorCommand::VOLTAGE:
+            motors->move_voltage((int32_t)std::lround(command));
+            break;
+        case MotorCommand::VELOCITY:
+            motors->move_velocity((int32_t)std::lround(command));
+            break;
+    }
+}
+
+/**
+ * Sets the current limit for the motors in one motor group.
+ *
+ * @param group The motor group's index in getMotors().
+ * @param limit The current limit in milliamps.
+ */
+void Drivetrain::setCurrentLimit(size_t group, int32_t limit) {
+    std::array<pros::MotorGroup*, MAX_MOTOR_GROUPS> groups;
+    if (group < getMotors(groups)) {
+        groups[group]->set_current_limit_all(limit);
+    }
+}
+
+/**
+ * Reads the temperature, velocity, current draw and voltage of every motor in a single pass, without allocating.
+ *
+ * @param snapshot The snapshot to fill.
+ */
+void Drivetrain::getSnapshot(DrivetrainSnapshot &snapshot) {
+    std::array<pros::MotorGroup*, MAX_MOTOR_GROUPS> groups;
+    snapshot.timestamp = pros::millis();
+    snapshot.groupCount = std::min(getMotors(groups), DrivetrainSnapshot::MAX_GROUPS);
+
+    for (size_t i = 0; i < snapshot.groupCount; i++) {
+        DrivetrainSnapshot::Group &group = snapshot.groups[i];
+        group.motorCount = std::min((size_t)std::max((int)groups[i]->size(), 0), DrivetrainSnapshot::MAX_MOTORS_PER_GROUP);
+        for (size_t motor = 0; motor < group.motorCount; motor++) {
+            group.motors[motor] = {groups[i]->get_temperature(motor), groups[i]->get_actual_velocity(motor),
+                                   groups[i]->get_current_draw(motor), groups[i]->get_voltage(motor)};
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#include <cmath>
+#include "lib/exitcondition.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * Sets the range and time for the exit condition.
+ * 
+ * @param range the error range in the same units as the error. Set to 0 to disable.
+ * @param time how long the error has to stay within the range in milliseconds
+ */
+void ExitCondition::setExit(double range, int time) {
+    this->range = range;
+    this->time = time;
+}
+
+/**
+ * Updates the exit condition with the current error.
+ * 
+ * @param error the current error
+ * @return whether or not the exit condition has been met
+ */
+bool ExitCondition::update(double error) {
+    if (range == 0) {
+        return false;
+    }
+
+    int now = pros::millis();
+    if (std::abs(error) >= range) {
+        enterTime = -1;
+    } else if (enterTime == -1) {
+        enterTime = now;
+    }
+
+    if (enterTime != -1 && now - enterTime >= time) {
+        done = true;
+    }
+
+    return done;
+}
+
+/**
+ * Resets the exit condition.
+ * It is highly recommended to call this method before starting a new motion.
+ */
+void ExitCondition::reset() {
+    enterTime = -1;
+    done = false;
+}
@@ -1,22 +1,50 @@
+#include <algorithm>
 #include <cmath>
 #include "lib/holonomicchassis.hpp"
+#include "util/angle.hpp"
 #include "pros/rtos.hpp"
 
 /**
  * @brief Drive the robot at a specific angle with translational and rotational speeds.
+ * If a wheel would need more than full speed, the wheel speeds are scaled down so the robot keeps driving in the requested direction.
+ * See setRotationPriority for how the motor range is shared between translation and rotation.
+ * 
  * @param angle The angle to drive in radians.
- * @param transSpeed The translational speed.
- * @param rotSpeed The rotational speed.
+ * @param transSpeed The translational speed (0 - 127).
+ * @param rotSpeed The rotational speed (-127 to 127).
+ */
+void HolonomicChassis::driveAngle(double angle, double transSpeed, double rotSpeed) {
+    std::array<double, 4> speeds = HolonomicMixer::mix(angle, transSpeed, rotSpeed, rotationPriority);
+    drivetrain->setMotorSpeeds({speeds[0], speeds[1], speeds[2], speeds[3]}, MotorCommand::SPEED);
+}
+
+/**
+ * @brief Sets how the motor range is shared between translation and rotation when the wheels saturate.
+ * Rotation always gets whatever range translation leaves free, and is guaranteed at least this share of the range.
+ * Translation is then scaled down on all four wheels together to fit in what is left, so its direction never changes.
+ * 
+ * 0 keeps the full translation speed and only turns with the leftover range.
+ * 
+ * 1 always keeps the full rotation speed and slows translation to make room.
+ * 
+ * @param priority The share of the motor range guaranteed to rotation (0 - 1).
  */
-void HolonomicChassis::driveAngle(double angle, int transSpeed, int rotSpeed) {
-	double adjustedAngle = angle;
-	int x = cos(adjustedAngle) * transSpeed;
-	int y = sin(adjustedAngle) * transSpeed;
-
-	drivetrain->setMotorSpeeds({y+x+rotSpeed,
-                                -y+x+rotSpeed,
-                                y-x+rotSpeed,
-                                -y-x+rotSpeed});
+void HolonomicChassis::setRotationPriority(double priority) {
+    rotationPriority = std::clamp(priority, 0.0, 1.0);
+}
+
+/**
+ * @brief Converts a direction on the field to the angle driveAngle expects.
+ * @param x The x-component of the direction on the field.
+ * @param y The y-component of the direction on the field.
+ * @param heading The robot's heading in radians.
+ * @return The angle in the robot's frame in radians.
+ */
+double HolonomicChassis::fieldToDriveAngle(double x, double y, double heading) {
+    // Rotating into the robot's frame gives the same frame odometry tracks in, where +x is the robot's left
+    // because the heading increases clockwise. driveAngle takes +x as the robot's right
+    Pose local = Pose(x, y, 0).rotate(heading);
+    return atan2(local.getY(), -local.getX());
 }
 
 /**
@@ -33,7 +61,9 @@ void HolonomicChassis::fieldCentricDrive(int leftX, int leftY, int rightX) {
     double targetAngle = atan2(y, x);
     double speed = scaleInput(sqrt(x*x + y*y));
 
-	driveAngle(targetAngle + odometry->getRotationRadians(), speed, r);
+	// Use the heading the tracking task already measured instead of reading the IMU on the driver's task
+	double heading = tracking ? getPredictedHeading() : odometry->getRotationRadians();
+	driveAngle(targetAngle + heading, speed, r);
 }
 
 /**
@@ -54,19 +84,225 @@ void HolonomicChassis::robotCentricDrive(int leftX, int leftY, int rightX) {
 }
 
 /**
- * @brief Move the robot to a specific position using PID control.
+ * @brief Move the robot to a specific pose, translating and rotating at the same time.
+ * The robot drives along the straight line to the target in field coordinates while turning to the target heading.
+ * If params.maxVelocity and params.maxAcceleration are set, the translation follows a trapezoidal profile with feedforward,
+ * and the heading is blended along with it so both finish together. The lateral and turn PIDs correct any error.
+ * 
+ * @param targetPose The target pose to move to.
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The motion parameters.
+ * @param async If true, the motion runs in the background and this function returns immediately.
+ */
+void HolonomicChassis::moveToPose(Pose targetPose, int timeout, MoveToPoseParams params, bool async) {
+    if (!drivetrain || !odometry || !lateralPID || !turnPID) {
+        return;
+    }
+
+    runMotion([this, targetPose, timeout, params] {
+        moveToPoseLoop(targetPose, timeout, params);
+    }, async);
+}
+
+/**
+ * @brief The control loop behind moveToPose. Blocks until the motion has finished.
  * @param targetPose The target pose to move to.
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The motion parameters.
+ */
+void HolonomicChassis::moveToPoseLoop(Pose targetPose, int timeout, MoveToPoseParams params) {
+    ExitCondition smallExit(lateralPID->getSmallErrorRange(), params.smallErrorTime);
+    ExitCondition largeExit(lateralPID->getLargeErrorRange(), params.largeErrorTime);
+    lateralPID->reset();
+    turnPID->reset();
+
+    Pose startPose = getPose();
+    double distance = startPose.distanceTo(targetPose);
+    double headingChange = angleError(targetPose.getTheta(), startPose.getTheta());
+
+    // Unit vector along the straight line to the target
+    double directionX = distance > 0 ? (targetPose.getX() - startPose.getX()) / distance : 0;
+    double directionY = distance > 0 ? (targetPose.getY() - startPose.getY()) / distance : 0;
+
+    // The profile starts from the robot's current speed along the line, so chained motions don't stop in between.
+    // It ends at the same fraction of maxVelocity as minSpeed is of maxSpeed
+    bool profiled = params.maxVelocity != 0 && params.maxAcceleration != 0;
+    MotionProfile profile;
+    if (profiled) {
+        Pose currentVelocity = getVelocity();
+        double startVelocity = currentVelocity.getX() * directionX + currentVelocity.getY() * directionY;
+        double endVelocity = params.maxVelocity * params.minSpeed / params.maxSpeed;
+        profile = MotionProfile::trapezoidal(distance, params.maxVelocity, params.maxAcceleration, startVelocity, endVelocity);
+    }
+
+    bool exitedEarly = false;
+
+    uint32_t startTime = pros::millis();
+    uint32_t loopTime = startTime;
+
+    while (!cancelRequested && (timeout == 0 || (int)(pros::millis() - startTime) < timeout)) {
+        Pose currentPose = getPose();
+        double time = (pros::millis() - startTime) / 1000.0;
+
+        // Setpoint along the line, and the heading blended in proportion to the distance covered
+        ProfileState state = profiled ? profile.sample(time) : ProfileState{distance, 0, 0};
+        double progress = distance > 0 ? state.position / distance : 1;
+        Pose setpoint(startPose.getX() + directionX * state.position,
+                      startPose.getY() + directionY * state.position,
+                      startPose.getTheta() + headingChange * progress);
+
+        // Feedforward along the line
+        double feedforwardSpeed = profiled ? feedforward.calculate(state.velocity, state.acceleration) : 0;
+        double speedX = directionX * feedforwardSpeed;
+        double speedY = directionY * feedforwardSpeed;
+
+        // Feedback towards the setpoint
+        double errorX = setpoint.getX() - currentPose.getX();
+        double errorY = setpoint.getY() - currentPose.getY();
+        double error = std::hypot(errorX, errorY);
+        double correction = lateralPID->calculate(0, error);
+        if (error > 0) {
+            speedX += correction * errorX / error;
+            speedY += correction * errorY / error;
+        }
+
+        double rotSpeed = turnPID->calculate(0, radToDeg(angleError(setpoint.getTheta(), currentPose.getTheta())));
+
+        // Chained motions hand over to the next motion while still moving, either once in range or once the target is behind the robot
+        double targetError = currentPose.distanceTo(targetPose);
+        double remaining = (targetPose.getX() - currentPose.getX()) * directionX + (targetPose.getY() - currentPose.getY()) * directionY;
+        if ((params.earlyExitRange != 0 && targetError < params.earlyExitRange) || (params.minSpeed != 0 && remaining < 0)) {
+            exitedEarly = true;
+            break;
+        }
+
+        bool profileDone = !profiled || time >= profile.getDuration();
+        if (profileDone && (smallExit.update(targetError) || largeExit.update(targetError))) {
+            break;
+        }
+
+        // Limit the combined translation and rotation speed, scaling both together
+        double transSpeed = std::hypot(speedX, speedY);
+        if (params.minSpeed != 0 && transSpeed > 0) {
+            transSpeed = std::max(transSpeed, params.minSpeed);
+        }
+        double ratio = (transSpeed + std::abs(rotSpeed)) / params.maxSpeed;
+        if (ratio > 1) {
+            transSpeed /= ratio;
+            rotSpeed /= ratio;
+        }
+
+        driveAngle(fieldToDriveAngle(speedX, speedY, currentPose.getTheta()), transSpeed, rotSpeed);
+
+        pros::Task::delay_until(&loopTime, 10);
+    }
+
+    if (!exitedEarly) {
+        stop();
+    }
+}
+
+/**
+ * @brief Follow a path of waypoints using pure pursuit.
+ * The robot strafes straight at the lookahead point while the turn PID holds its starting heading.
+ * 
+ * @param path The waypoints to follow, spaced closely together (a few inches apart).
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The pure pursuit parameters.
+ * @param async If true, the motion runs in the background and this function returns immediately.
  */
-void HolonomicChassis::moveToPose(Pose targetPose) {
-    // TODO: Implement MoveTo for HolonomicChassis
+void HolonomicChassis::followPath(std::vector<Waypoint> path, int timeout, PurePursuitParams params, bool async) {
+    if (!drivetrain || !odometry || path.empty()) {
+        return;
+    }
+
+    runMotion([this, path, timeout, params] {
+        followPathLoop(path, timeout, params);
+    }, async);
+}
+
+/**
+ * @brief The control loop behind followPath. Blocks until the path has finished.
+ * @param path The waypoints to follow.
+ * @param timeout The maximum time the motion may take in milliseconds. Set to 0 to disable.
+ * @param params The pure pursuit parameters.
+ */
+void HolonomicChassis::followPathLoop(std::vector<Waypoint> path, int timeout, PurePursuitParams params) {
+    PurePursuit follower(path);
+    if (turnPID) {
+        turnPID->reset();
+    }
+    double targetHeading = getPose().getTheta();
+
+    double velocity = path[0].velocity;
+    int startTime = pros::millis();
+
+    while (!cancelRequested && (timeout == 0 || (int)pros::millis() - startTime < timeout)) {
+        Pose currentPose = getPose();
+
+        // The lookahead distance follows the speed of the previous iteration
+        follower.update(currentPose, getLookahead(velocity, params));
+        if (follower.isFinished(currentPose, params.endDistance)) {
+            break;
+        }
+
+        velocity = std::min(follower.getClosest().velocity, params.maxSpeed);
+        Waypoint lookahead = follower.getLookahead();
+
+        // Direction of the lookahead point relative to the robot
+        double driveDirection = fieldToDriveAngle(lookahead.x - currentPose.getX(), lookahead.y - currentPose.getY(), currentPose.getTheta());
+
+        double rotSpeed = 0;
+        if (turnPID) {
+            rotSpeed = turnPID->calculate(0, radToDeg(angleError(targetHeading, currentPose.getTheta())));
+            rotSpeed = std::clamp(rotSpeed, -params.maxSpeed, params.maxSpeed);
+        }
+
+        driveAngle(driveDirection, velocity, rotSpeed);
+
+        pros::delay(10);
+    }
+
+    stop();
 }
 
-/**       
+/**
  * @brief Turn the robot to a specific angle using PID control.
- * 0 Degrees is facing "forward" from the starting orientation.
+ * 0 Degrees is facing "forward" from the starting orientation. The robot turns whichever way is shorter.
  * 
  * @param targetAngle The target angle to turn to (in degrees).
+ * @param timeout The maximum time the turn may take in milliseconds. Set to 0 to disable.
+ * @param params The turn parameters. Set lockedSide for a swing turn.
+ * @param async If true, the turn runs in the background and this function returns immediately.
+ */
+void HolonomicChassis::turnAngle(double targetAngle, int timeout, TurnParams params, bool async) {
+    if (!drivetrain || !odometry || !turnPID) {
+        return;
+    }
+
+    double targetHeading = degToRad(targetAngle);
+    runMotion([this, targetHeading, timeout, params] {
+        turnLoop([targetHeading] { return targetHeading; }, timeout, params);
+    }, async);
+}
+
+/**
+ * @brief Applies a turning speed to the drivetrain. Positive speeds increase the heading.
+ * @param speed The turning speed (-127 to 127).
+ * @param lockedSide The side of the robot to hold still, or NONE to turn in place.
+ */
+void HolonomicChassis::setTurnSpeed(double speed, SwingSide lockedSide) {
+    // Every module spins the same direction to rotate (see driveAngle)
+    double leftSpeed = lockedSide == SwingSide::LEFT ? 0 : speed;
+    double rightSpeed = lockedSide == SwingSide::RIGHT ? 0 : speed;
+    drivetrain->setMotorSpeeds({leftSpeed, rightSpeed, leftSpeed, rightSpeed}, MotorCommand::SPEED);
+}
+
+/**
+ * @brief Applies a straight driving speed to the drivetrain. Positive speeds drive forwards.
+ * @param speed The driving speed (-127 to 127).
  */
-void HolonomicChassis::turnAngle(double targetAngle) {
-    // TODO: Implement TurnAngle for HolonomicChassis
+void HolonomicChassis::setDriveSpeed(double speed) {
+    // Forward is +y in the module mixing (see driveAngle), so the right modules spin backwards
+    drivetrain->setMotorSpeeds({speed, -speed, speed, -speed}, MotorCommand::SPEED);
 }
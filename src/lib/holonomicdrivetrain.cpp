@@ -166,21 +166,49 @@ std::vector<pros::MotorGroup*> HolonomicDrivetrain::getMotors() {
 }
 
 /**
- * Sets the speeds of the motors based on the speeds given.
- * The speeds array should contain the speeds for the front left, front right,
- * back left, back right, and optionally side motors in that order.
+ * Fills an array with the motor groups on this drivetrain, in the order of getMotors(), without allocating.
  * 
- * @param speeds An array containing the speeds for the motors.
+ * @param groups The array to fill.
+ * @return The number of motor groups.
  */
-void HolonomicDrivetrain::setMotorSpeeds(std::initializer_list<int> speeds) {
-    frontLeftModule->move(speeds.begin()[0]);
-    frontRightModule->move(speeds.begin()[1]);
-    backLeftModule->move(speeds.begin()[2]);
-    backRightModule->move(speeds.begin()[3]);
-
-    if (sideMotors != nullptr && speeds.size() >= 5) {
-        sideMotors->move(speeds.begin()[4]);
+size_t HolonomicDrivetrain::getMotors(std::array<pros::MotorGroup*, MAX_MOTOR_GROUPS> &groups) {
+    groups[0] = frontLeftModule;
+    groups[1] = frontRightModule;
+    groups[2] = backLeftModule;
+    groups[3] = backRightModule;
+
+    if (sideMotors != nullptr) {
+        groups[4] = sideMotors;
+        return 5;
     }
+    return 4;
+}
+
+/**
+ * Returns how many motor groups, from the start of getMotors(), turn the robot in place.
+ * The four modules turn the robot. The side motors point at its center, so they stay still.
+ */
+size_t HolonomicDrivetrain::getTurningMotorCount() {
+    return 4;
 }
 
+/**
+ * Sends a command to every motor group.
+ * The commands array should contain the commands for the front left, front right,
+ * back left, back right, and optionally side motors in that order.
+ * The change in each output is limited by the drivetrain's acceleration limits.
+ * 
+ * @param commands An array containing the commands for the motors.
+ * @param mode How the commands are sent: motor speed, voltage, or closed-loop velocity.
+ */
+void HolonomicDrivetrain::setMotorSpeeds(const std::array<double, MAX_MOTOR_GROUPS> &commands, MotorCommand mode) {
+    updateLimiter();
+    sendCommand(0, frontLeftModule, commands[0], mode);
+    sendCommand(1, frontRightModule, commands[1], mode);
+    sendCommand(2, backLeftModule, commands[2], mode);
+    sendCommand(3, backRightModule, commands[3], mode);
 
+    if (sideMotors != nullptr) {
+        sendCommand(4, sideMotors, commands[4], mode);
+    }
+}
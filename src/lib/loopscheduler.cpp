@@ -0,0 +1,112 @@
+#include <algorithm>
+#include "lib/loopscheduler.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Sets the drive callback, which reads the controller and commands the drivetrain. It runs before every other callback.
+ * @param function The callback.
+ * @param period How often it runs in milliseconds.
+ */
+void LoopScheduler::setDrive(std::function<void()> function, uint32_t period) {
+    callbacks[DRIVE].function = function;
+    callbacks[DRIVE].period = std::max(period, tickPeriod);
+    callbacks[DRIVE].stats = LoopStats();
+}
+
+/**
+ * @brief Adds a periodic callback, such as a mechanism's control code.
+ * @param function The callback.
+ * @param period How often it runs in milliseconds.
+ * @return The callback's id for getStats, or -1 if MAX_CALLBACKS callbacks have already been added.
+ */
+int LoopScheduler::add(std::function<void()> function, uint32_t period) {
+    for (size_t i = DRIVE + 1; i < MAX_CALLBACKS; i++) {
+        if (callbacks[i].period == 0) {
+            callbacks[i].function = function;
+            callbacks[i].period = std::max(period, tickPeriod);
+            callbacks[i].stats = LoopStats();
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Runs a callback if it is due and records its timing.
+ * @param callback The callback.
+ * @param now The start of the current tick in milliseconds.
+ */
+void LoopScheduler::runCallback(Callback &callback, uint32_t now) {
+    if (callback.period == 0 || !callback.function || (int32_t)(now - callback.nextRun) < 0) {
+        return;
+    }
+
+    uint64_t due = (uint64_t)callback.nextRun * 1000;
+    uint64_t start = pros::micros();
+    callback.function();
+    uint64_t end = pros::micros();
+
+    LoopStats &stats = callback.stats;
+    stats.runs++;
+    stats.lastRunTime = end - start;
+    stats.maxRunTime = std::max(stats.maxRunTime, stats.lastRunTime);
+    stats.lastLatency = end > due ? end - due : 0;
+    stats.maxLatency = std::max(stats.maxLatency, stats.lastLatency);
+    stats.totalLatency += stats.lastLatency;
+
+    // Skip runs that are already late instead of running them back to back to catch up
+    callback.nextRun += callback.period;
+    if (end > (uint64_t)callback.nextRun * 1000) {
+        stats.deadlineMisses++;
+        uint32_t endMillis = end / 1000;
+        while ((int32_t)(endMillis - callback.nextRun) >= 0) {
+            callback.nextRun += callback.period;
+        }
+    }
+}
+
+/**
+ * @brief Runs the callbacks until stop() is called from one of them. Blocks the calling task.
+ */
+void LoopScheduler::run() {
+    uint32_t now = pros::millis();
+    for (Callback &callback : callbacks) {
+        callback.nextRun = now;
+    }
+
+    running = true;
+    while (running) {
+        for (Callback &callback : callbacks) {
+            runCallback(callback, now);
+        }
+
+        // delay_until advances now by exactly one tick, even if the callbacks ran long.
+        // If they ran longer than a tick, restart the ticks from the current time instead of firing the missed ones back to back
+        pros::Task::delay_until(&now, tickPeriod);
+        uint32_t actual = pros::millis();
+        if (actual - now >= tickPeriod) {
+            now = actual;
+        }
+    }
+}
+
+/**
+ * @brief Get the timing statistics of a callback.
+ * @param id The callback's id, or DRIVE for the drive callback.
+ * @return The statistics.
+ */
+LoopStats LoopScheduler::getStats(int id) const {
+    if (id < 0 || id >= (int)MAX_CALLBACKS) {
+        return LoopStats();
+    }
+    return callbacks[id].stats;
+}
+
+/**
+ * @brief Resets the timing statistics of every callback.
+ */
+void LoopScheduler::resetStats() {
+    for (Callback &callback : callbacks) {
+        callback.stats = LoopStats();
+    }
+}
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <cmath>
+#include "lib/motorhealth.hpp"
+
+/**
+ * @brief Adds a reading to a motor's moving averages.
+ * @param motor The motor's stats.
+ * @param sample The reading.
+ */
+void MotorHealthMonitor::updateStats(MotorStats &motor, const MotorSample &sample) {
+    double current = std::abs(sample.currentDraw);
+    double velocity = std::abs(sample.getVelocity());
+    double voltage = std::abs(sample.voltage);
+
+    if (motor.samples == 0) {
+        motor.current = current;
+        motor.currentVariance = 0;
+        motor.velocity = velocity;
+        motor.voltage = voltage;
+    } else {
+        // Exponentially weighted mean and variance, updated together in one step
+        double alpha = params.smoothing;
+        double difference = current - motor.current;
+        double increment = alpha * difference;
+        motor.current += increment;
+        motor.currentVariance = (1 - alpha) * (motor.currentVariance + difference * increment);
+        motor.velocity += alpha * (velocity - motor.velocity);
+        motor.voltage += alpha * (voltage - motor.voltage);
+    }
+    motor.samples++;
+}
+
+/**
+ * @brief Raises, keeps or clears a motor's faults, and reports any change.
+ * @param motor The motor's index in the sampler's records.
+ * @param group The motor's group.
+ * @param detected The faults whose conditions hold in this reading.
+ * @param time When the reading was taken, from pros::millis().
+ */
+void MotorHealthMonitor::setFaults(size_t motor, size_t group, uint8_t detected, uint32_t time) {
+    MotorStats &motorStats = stats[motor];
+
+    // A fault stays raised until its condition has been gone for clearTime, so a flickering condition is one fault
+    uint8_t raised = 0;
+    for (size_t fault = 0; fault < FAULT_COUNT; fault++) {
+        uint8_t mask = 1 << fault;
+        if (detected & mask) {
+            motorStats.lastSeen[fault] = time;
+            raised |= mask;
+        } else if ((faults[motor] & mask) && time - motorStats.lastSeen[fault] < params.clearTime) {
+            raised |= mask;
+        }
+    }
+
+    uint8_t added = raised & ~faults[motor];
+    if (raised == faults[motor]) {
+        return;
+    }
+    if (added & DISCONNECTED) {
+        disconnectCounts[motor]++;
+    }
+    faults[motor] = raised;
+    faultHistory[motor] |= raised;
+
+    if (blackBox != nullptr) {
+        blackBox->logEvent(eventId, {(float)motor, (float)group, (float)raised,
+                                     (float)motorStats.current, (float)motorStats.velocity, (float)motorStats.voltage});
+    }
+
+    if (added != 0 && controller != nullptr && params.rumbleInterval != 0 && (!rumbled || time - lastRumble >= params.rumbleInterval)) {
+        // Long rumbles for a disconnect, short ones for everything else
+        controller->rumble(added & DISCONNECTED ? "---" : ". . .");
+        lastRumble = time;
+        rumbled = true;
+    }
+}
+
+/**
+ * @brief Checks the latest sample, if there is a new one.
+ */
+void MotorHealthMonitor::update() {
+    MotorRecord record;
+    if (sampler == nullptr || !sampler->getLatest(record) || record.timestamp == lastTimestamp) {
+        return;
+    }
+    lastTimestamp = record.timestamp;
+
+    // Start over whenever the motors change
+    if (record.motorCount != motorCount) {
+        motorCount = record.motorCount;
+        stats.fill({});
+        faults.fill(0);
+    }
+
+    for (size_t i = 0; i < motorCount; i++) {
+        if (record.motors[i].isConnected()) {
+            updateStats(stats[i], record.motors[i]);
+        } else {
+            // Readings right after a reconnect aren't comparable with the old averages
+            stats[i].samples = 0;
+        }
+    }
+
+    // Group indexes are 4 bits in each sample
+    struct GroupTotals {
+        size_t count = 0;
+        double current = 0;
+        double currentVariance = 0;
+        double velocity = 0;
+        double voltage = 0;
+    };
+    std::array<GroupTotals, 16> groups;
+    for (size_t i = 0; i < motorCount; i++) {
+        const MotorStats &motor = stats[i];
+        if (motor.samples < params.warmupSamples) {
+            continue;
+        }
+        GroupTotals &group = groups[record.motors[i].getGroup()];
+        group.count++;
+        group.current += motor.current;
+        group.currentVariance += motor.currentVariance;
+        group.velocity += motor.velocity;
+        group.voltage += motor.voltage;
+    }
+
+    for (size_t i = 0; i < motorCount; i++) {
+        const MotorStats &motor = stats[i];
+        size_t groupIndex = record.motors[i].getGroup();
+        const GroupTotals &group = groups[groupIndex];
+        uint8_t detected = 0;
+
+        if (!record.motors[i].isConnected()) {
+            detected |= DISCONNECTED;
+        } else if (motor.samples >= params.warmupSamples && group.count > 1) {
+            // Compare with the average of the other motors in the group
+            double others = group.count - 1;
+            double otherCurrent = (group.current - motor.current) / others;
+            double otherVelocity = (group.velocity - motor.velocity) / others;
+            double otherVoltage = (group.voltage - motor.voltage) / others;
+            double spread = std::sqrt(group.currentVariance / group.count);
+
+            if (motor.current - otherCurrent > std::max(params.minCurrentExcess, params.currentDeviations * spread)) {
+                detected |= OVERCURRENT;
+            }
+            if (otherVelocity > params.minVelocity && motor.velocity < params.stallRatio * otherVelocity) {
+                detected |= STALLED;
+            }
+            if (otherVoltage > params.minVoltage && motor.voltage < params.powerLossRatio * otherVoltage) {
+                detected |= POWER_LOSS;
+            }
+        }
+
+        setFaults(i, groupIndex, detected, record.timestamp);
+    }
+}
+
+/**
+ * @brief Checks if any motor has a fault right now.
+ * @return True if any motor has a fault.
+ */
+bool MotorHealthMonitor::hasFaults() const {
+    return std::any_of(faults.begin(), faults.begin() + motorCount, [](uint8_t fault) { return fault != 0; });
+}
+
+/**
+ * @brief Clears the fault history and disconnect counts. Faults whose conditions still hold stay raised.
+ */
+void MotorHealthMonitor::clearFaults() {
+    faultHistory = faults;
+    disconnectCounts.fill(0);
+}
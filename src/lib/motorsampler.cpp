@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <cmath>
+#include "lib/motorsampler.hpp"
+#include "pros/error.h"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Reads every motor into a record.
+ * @param record The record to fill.
+ */
+void MotorSampler::sample(MotorRecord &record) {
+    std::array<pros::MotorGroup*, Drivetrain::MAX_MOTOR_GROUPS> drivetrainGroups = {};
+    size_t drivetrainGroupCount = drivetrain != nullptr ? drivetrain->getMotors(drivetrainGroups) : 0;
+
+    record.timestamp = pros::millis();
+    record.motorCount = 0;
+    for (size_t group = 0; group < Drivetrain::MAX_MOTOR_GROUPS + extraGroupCount; group++) {
+        pros::MotorGroup *motors = nullptr;
+        if (group < Drivetrain::MAX_MOTOR_GROUPS) {
+            motors = group < drivetrainGroupCount ? drivetrainGroups[group] : nullptr;
+        } else {
+            motors = extraGroups[group - Drivetrain::MAX_MOTOR_GROUPS];
+        }
+        if (motors == nullptr) {
+            continue;
+        }
+
+        int motorCount = motors->size();
+        for (int motor = 0; motor < motorCount && record.motorCount < MotorRecord::MAX_MOTORS; motor++) {
+            double velocity = motors->get_actual_velocity(motor);
+            int32_t current = motors->get_current_draw(motor);
+            int32_t voltage = motors->get_voltage(motor);
+            double temperature = motors->get_temperature(motor);
+
+            // Failed reads return PROS_ERR or PROS_ERR_F
+            MotorSample &sample = record.motors[record.motorCount++];
+            sample.flags = (uint8_t)(group << 4);
+            if (current == PROS_ERR || voltage == PROS_ERR || !std::isfinite(velocity) || !std::isfinite(temperature)) {
+                sample = {0, 0, 0, 0, (uint8_t)(sample.flags | MotorSample::DISCONNECTED)};
+                continue;
+            }
+            sample.velocity = (int16_t)std::clamp(std::lround(velocity * 10), -32768L, 32767L);
+            sample.currentDraw = (int16_t)std::clamp(current, (int32_t)-32768, (int32_t)32767);
+            sample.voltage = (int16_t)std::clamp(voltage, (int32_t)-32768, (int32_t)32767);
+            sample.temperature = (uint8_t)std::clamp(std::lround(temperature), 0L, 255L);
+        }
+    }
+}
+
+/**
+ * @brief Adds a mechanism's motor group to be read along with the drivetrain. Add groups before starting the sampler.
+ * @param motors The motor group.
+ * @return The group's index in the records, or -1 if MAX_EXTRA_GROUPS groups have already been added.
+ */
+int MotorSampler::addMotors(pros::MotorGroup *motors) {
+    if (motors == nullptr || extraGroupCount == MAX_EXTRA_GROUPS) {
+        return -1;
+    }
+    extraGroups[extraGroupCount] = motors;
+    return Drivetrain::MAX_MOTOR_GROUPS + extraGroupCount++;
+}
+
+/**
+ * @brief Writes a record into the next slot.
+ * @param record The record to write.
+ */
+void MotorSampler::publish(const MotorRecord &record) {
+    uint32_t index = recordCount.load(std::memory_order_relaxed);
+    Slot &slot = slots[index % HISTORY_SIZE];
+
+    // Odd while writing, so readers that overlap the write retry
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.index = index;
+    slot.record = record;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    recordCount.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Copies a record out of the ring buffer.
+ * @param index The record to copy, counting from the first record written.
+ * @param record Where to copy the record.
+ * @return False if the record has already been overwritten.
+ */
+bool MotorSampler::read(uint32_t index, MotorRecord &record) const {
+    const Slot &slot = slots[index % HISTORY_SIZE];
+    while (true) {
+        uint32_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            // The sampler is writing this slot, which means the record it held is being replaced
+            return false;
+        }
+        uint32_t slotIndex = slot.index;
+        record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) {
+            return slotIndex == index;
+        }
+    }
+}
+
+/**
+ * @brief Starts the sampler task if it is not already running.
+ * If the sampler was just stopped, this waits for the previous task to finish its last pass, so two tasks never publish at once.
+ * @param priority The task priority. Keep it below the control tasks.
+ */
+void MotorSampler::start(uint32_t priority) {
+    if (running) {
+        return;
+    }
+    // The previous task only notices stop() when it wakes up, which can take up to a period
+    while (!stopped) {
+        pros::delay(1);
+    }
+    running = true;
+    stopped = false;
+    pros::Task task([this] {
+        MotorRecord record;
+        uint32_t loopTime = pros::millis();
+        while (running) {
+            sample(record);
+            publish(record);
+            pros::Task::delay_until(&loopTime, period);
+        }
+        stopped = true;
+    }, priority, TASK_STACK_DEPTH_DEFAULT, "Motor Sampler");
+}
+
+/**
+ * @brief Get the most recent record, without any device calls.
+ * @param record Where to copy the record.
+ * @return False if nothing has been sampled yet.
+ */
+bool MotorSampler::getLatest(MotorRecord &record) const {
+    while (true) {
+        uint32_t count = recordCount.load(std::memory_order_acquire);
+        if (count == 0) {
+            return false;
+        }
+        // Only fails if the sampler lapped the whole buffer during the copy, so try the new latest record
+        if (read(count - 1, record)) {
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Get the most recent records, without any device calls.
+ * @param records Where to copy the records, oldest first.
+ * @param count The most records to copy. At most HISTORY_SIZE - 1 are available.
+ * @return The number of records copied.
+ */
+size_t MotorSampler::getHistory(MotorRecord *records, size_t count) const {
+    // The oldest slot may be the next one the sampler overwrites, so it isn't offered
+    uint32_t newest = recordCount.load(std::memory_order_acquire);
+    count = std::min({count, (size_t)newest, HISTORY_SIZE - 1});
+
+    size_t copied = 0;
+    for (uint32_t index = newest - count; index != newest; index++) {
+        // Records overwritten during the copy are skipped, so the result stays in order
+        if (read(index, records[copied])) {
+            copied++;
+        }
+    }
+    return copied;
+}
@@ -0,0 +1,259 @@
+#include <algorithm>
+#include <cmath>
+#include "lib/occupancygrid.hpp"
+
+/**
+ * @brief Construct a new OccupancyGrid object covering a 144 x 144 inch field. The field walls are added automatically.
+ * @param robotRadius The radius of a circle around the robot's tracking center that covers the whole robot (in inches).
+ * @param originX The x coordinate of the field's lower left corner (in inches).
+ * @param originY The y coordinate of the field's lower left corner (in inches).
+ */
+OccupancyGrid::OccupancyGrid(double robotRadius, double originX, double originY)
+: resolution(144.0 / WIDTH), originX(originX), originY(originY), robotRadius(robotRadius) {
+    // The robot's center can't get closer to a wall than its radius. Each wall is a thin rectangle just outside the field
+    double minX = originX;
+    double minY = originY;
+    double maxX = originX + WIDTH * resolution;
+    double maxY = originY + HEIGHT * resolution;
+    fillRectangle(staticCells, minX - 1, minY - 1, minX, maxY + 1);
+    fillRectangle(staticCells, maxX, minY - 1, maxX + 1, maxY + 1);
+    fillRectangle(staticCells, minX - 1, minY - 1, maxX + 1, minY);
+    fillRectangle(staticCells, minX - 1, maxY, maxX + 1, maxY + 1);
+    clearChanges();
+}
+
+/**
+ * @brief Sets a cell in a layer, recording the change if the cell switched between free and occupied.
+ */
+void OccupancyGrid::setCell(std::array<uint64_t, WORDS> &layer, size_t cell, bool value) {
+    bool wasOccupied = isOccupied(cell);
+
+    uint64_t mask = (uint64_t)1 << (cell % 64);
+    if (value) {
+        layer[cell / 64] |= mask;
+    } else {
+        layer[cell / 64] &= ~mask;
+    }
+
+    if (isOccupied(cell) != wasOccupied) {
+        if (changeCount < MAX_CHANGES) {
+            changes[changeCount++] = cell;
+        } else {
+            changesOverflowed = true;
+        }
+    }
+}
+
+/**
+ * @brief Marks every cell within the rectangle grown by the robot's radius in a layer.
+ */
+void OccupancyGrid::fillRectangle(std::array<uint64_t, WORDS> &layer, double minX, double minY, double maxX, double maxY) {
+    int minColumn = std::max(0, (int)std::floor((minX - robotRadius - originX) / resolution));
+    int maxColumn = std::min(WIDTH - 1, (int)std::floor((maxX + robotRadius - originX) / resolution));
+    int minRow = std::max(0, (int)std::floor((minY - robotRadius - originY) / resolution));
+    int maxRow = std::min(HEIGHT - 1, (int)std::floor((maxY + robotRadius - originY) / resolution));
+
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int column = minColumn; column <= maxColumn; column++) {
+            uint16_t cell = row * WIDTH + column;
+
+            // Distance from the cell's center to the rectangle, so the corners are rounded off like the robot
+            double dx = std::max({minX - cellX(cell), 0.0, cellX(cell) - maxX});
+            double dy = std::max({minY - cellY(cell), 0.0, cellY(cell) - maxY});
+            if (dx * dx + dy * dy <= robotRadius * robotRadius) {
+                setCell(layer, cell, true);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Marks every cell within the circle grown by the robot's radius in a layer.
+ */
+void OccupancyGrid::fillCircle(std::array<uint64_t, WORDS> &layer, double x, double y, double radius) {
+    double reach = radius + robotRadius;
+    int minColumn = std::max(0, (int)std::floor((x - reach - originX) / resolution));
+    int maxColumn = std::min(WIDTH - 1, (int)std::floor((x + reach - originX) / resolution));
+    int minRow = std::max(0, (int)std::floor((y - reach - originY) / resolution));
+    int maxRow = std::min(HEIGHT - 1, (int)std::floor((y + reach - originY) / resolution));
+
+    for (int row = minRow; row <= maxRow; row++) {
+        for (int column = minColumn; column <= maxColumn; column++) {
+            uint16_t cell = row * WIDTH + column;
+            double dx = cellX(cell) - x;
+            double dy = cellY(cell) - y;
+            if (dx * dx + dy * dy <= reach * reach) {
+                setCell(layer, cell, true);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Converts a position to the cell containing it.
+ * @param x The x coordinate (in inches).
+ * @param y The y coordinate (in inches).
+ * @return The cell index, or NO_CELL if the position is outside the grid.
+ */
+uint16_t OccupancyGrid::cellAt(double x, double y) const {
+    int column = (int)std::floor((x - originX) / resolution);
+    int row = (int)std::floor((y - originY) / resolution);
+    if (column < 0 || column >= WIDTH || row < 0 || row >= HEIGHT) {
+        return NO_CELL;
+    }
+    return row * WIDTH + column;
+}
+
+/**
+ * @brief Returns whether the robot's center can't be placed at a position. Positions outside the grid are occupied.
+ * @param x The x coordinate (in inches).
+ * @param y The y coordinate (in inches).
+ * @return True if the position is occupied.
+ */
+bool OccupancyGrid::isOccupied(double x, double y) const {
+    uint16_t cell = cellAt(x, y);
+    return cell == NO_CELL || isOccupied(cell);
+}
+
+/**
+ * @brief Returns whether the robot can drive in a straight line between two points without entering an occupied cell.
+ * @param x1 The x coordinate of the first point (in inches).
+ * @param y1 The y coordinate of the first point (in inches).
+ * @param x2 The x coordinate of the second point (in inches).
+ * @param y2 The y coordinate of the second point (in inches).
+ * @return True if the line is clear.
+ */
+bool OccupancyGrid::isLineClear(double x1, double y1, double x2, double y2) const {
+    // Walk the cells the line passes through in order, in cell units. This visits each cell once and can't skip
+    // over the corner of a cell, unlike sampling points along the line
+    double fromX = (x1 - originX) / resolution;
+    double fromY = (y1 - originY) / resolution;
+    double dx = (x2 - originX) / resolution - fromX;
+    double dy = (y2 - originY) / resolution - fromY;
+    int column = (int)std::floor(fromX);
+    int row = (int)std::floor(fromY);
+    int remaining = std::abs((int)std::floor(fromX + dx) - column) + std::abs((int)std::floor(fromY + dy) - row);
+    int stepX = dx > 0 ? 1 : -1;
+    int stepY = dy > 0 ? 1 : -1;
+
+    // How far along the line (0 - 1) the next column and row boundaries are, and the distance between boundaries
+    double deltaX = dx != 0 ? std::abs(1 / dx) : INFINITY;
+    double deltaY = dy != 0 ? std::abs(1 / dy) : INFINITY;
+    double nextX = dx != 0 ? (dx > 0 ? column + 1 - fromX : fromX - column) * deltaX : INFINITY;
+    double nextY = dy != 0 ? (dy > 0 ? row + 1 - fromY : fromY - row) * deltaY : INFINITY;
+
+    auto isBlocked = [this](int column, int row) {
+        return column < 0 || column >= WIDTH || row < 0 || row >= HEIGHT || isOccupied((uint16_t)(row * WIDTH + column));
+    };
+    while (!isBlocked(column, row)) {
+        if (remaining <= 0) {
+            return true;
+        }
+        if (std::abs(nextX - nextY) < 1e-9) {
+            // Exactly through a corner, which the robot can only pass if both cells beside it are clear
+            if (isBlocked(column + stepX, row) || isBlocked(column, row + stepY)) {
+                return false;
+            }
+            column += stepX;
+            row += stepY;
+            nextX += deltaX;
+            nextY += deltaY;
+            remaining -= 2;
+        } else if (nextX < nextY) {
+            column += stepX;
+            nextX += deltaX;
+            remaining--;
+        } else {
+            row += stepY;
+            nextY += deltaY;
+            remaining--;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Adds a rectangular field structure that never moves.
+ * @param minX The left edge (in inches).
+ * @param minY The bottom edge (in inches).
+ * @param maxX The right edge (in inches).
+ * @param maxY The top edge (in inches).
+ */
+void OccupancyGrid::addStaticRectangle(double minX, double minY, double maxX, double maxY) {
+    fillRectangle(staticCells, minX, minY, maxX, maxY);
+}
+
+/**
+ * @brief Adds a circular field structure that never moves.
+ * @param x The x coordinate of the center (in inches).
+ * @param y The y coordinate of the center (in inches).
+ * @param radius The radius (in inches).
+ */
+void OccupancyGrid::addStaticCircle(double x, double y, double radius) {
+    fillCircle(staticCells, x, y, radius);
+}
+
+/**
+ * @brief Adds the structures of the Push Back field: the center goals, the long goals, and the match loaders.
+ * The positions are approximate and assume the grid is centered on the field, with the alliance walls along x = +-72.
+ * Check them against your field and add margins with addStaticRectangle if needed.
+ */
+void OccupancyGrid::addPushBackField() {
+    double centerX = originX + WIDTH * resolution / 2;
+    double centerY = originY + HEIGHT * resolution / 2;
+
+    // Center goals, crossing in the middle of the field
+    addStaticCircle(centerX, centerY, 10);
+
+    // Long goals, one tile in from the field walls, running between the alliance walls
+    addStaticRectangle(centerX - 24, centerY + 46, centerX + 24, centerY + 50);
+    addStaticRectangle(centerX - 24, centerY - 50, centerX + 24, centerY - 46);
+
+    // Match loaders on the alliance walls, in line with the long goals
+    addStaticRectangle(centerX - 72, centerY + 44, centerX - 66, centerY + 52);
+    addStaticRectangle(centerX - 72, centerY - 52, centerX - 66, centerY - 44);
+    addStaticRectangle(centerX + 66, centerY + 44, centerX + 72, centerY + 52);
+    addStaticRectangle(centerX + 66, centerY - 52, centerX + 72, centerY - 44);
+}
+
+/**
+ * @brief Adds an obstacle seen by a sensor, such as another robot.
+ * @param x The x coordinate of the center (in inches).
+ * @param y The y coordinate of the center (in inches).
+ * @param radius The radius (in inches).
+ */
+void OccupancyGrid::addObstacle(double x, double y, double radius) {
+    fillCircle(dynamicCells, x, y, radius);
+}
+
+/**
+ * @brief Removes every obstacle added with addObstacle. Static structures are kept.
+ */
+void OccupancyGrid::clearObstacles() {
+    for (size_t word = 0; word < WORDS; word++) {
+        uint64_t bits = dynamicCells[word];
+        while (bits) {
+            size_t cell = word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            setCell(dynamicCells, cell, false);
+        }
+    }
+}
+
+/**
+ * @brief Get the cells that switched between free and occupied since clearChanges was last called.
+ * @param count Set to the number of changed cells.
+ * @return The changed cells, or nullptr if more than MAX_CHANGES cells changed.
+ */
+const uint16_t *OccupancyGrid::getChanges(size_t &count) const {
+    count = changeCount;
+    return changesOverflowed ? nullptr : changes.data();
+}
+
+/**
+ * @brief Forgets the recorded changes.
+ */
+void OccupancyGrid::clearChanges() {
+    changeCount = 0;
+    changesOverflowed = false;
+}
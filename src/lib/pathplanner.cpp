@@ -0,0 +1,518 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "lib/pathplanner.hpp"
+
+static constexpr float INFINITE_COST = std::numeric_limits<float>::infinity();
+
+void CellHeap::swap(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    positions[heap[a]] = a;
+    positions[heap[b]] = b;
+}
+
+// The sifts carry the moving cell in a hole instead of swapping at every level, which halves the writes
+void CellHeap::siftUp(size_t index) {
+    uint16_t cell = heap[index];
+    PlannerKey key = keys[cell];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!(key < keys[heap[parent]])) {
+            break;
+        }
+        heap[index] = heap[parent];
+        positions[heap[index]] = index;
+        index = parent;
+    }
+    heap[index] = cell;
+    positions[cell] = index;
+}
+
+void CellHeap::siftDown(size_t index) {
+    uint16_t cell = heap[index];
+    PlannerKey key = keys[cell];
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && keys[heap[child + 1]] < keys[heap[child]]) {
+            child++;
+        }
+        if (!(keys[heap[child]] < key)) {
+            break;
+        }
+        heap[index] = heap[child];
+        positions[heap[index]] = index;
+        index = child;
+    }
+    heap[index] = cell;
+    positions[cell] = index;
+}
+
+/**
+ * @brief Removes every cell. O(n) in the number of cells in the heap.
+ */
+void CellHeap::clear() {
+    for (size_t i = 0; i < size; i++) {
+        positions[heap[i]] = NOT_IN_HEAP;
+    }
+    size = 0;
+}
+
+/**
+ * @brief Inserts a cell, or changes its key if it is already in the heap.
+ * @param cell The cell index.
+ * @param key The cell's priority, lowest first.
+ */
+void CellHeap::push(uint16_t cell, PlannerKey key) {
+    if (contains(cell)) {
+        PlannerKey oldKey = keys[cell];
+        keys[cell] = key;
+        if (key < oldKey) {
+            siftUp(positions[cell]);
+        } else {
+            siftDown(positions[cell]);
+        }
+        return;
+    }
+
+    keys[cell] = key;
+    heap[size] = cell;
+    positions[cell] = size;
+    siftUp(size++);
+}
+
+/**
+ * @brief Removes a cell if it is in the heap.
+ * @param cell The cell index.
+ */
+void CellHeap::remove(uint16_t cell) {
+    if (!contains(cell)) {
+        return;
+    }
+
+    size_t index = positions[cell];
+    swap(index, --size);
+    positions[cell] = NOT_IN_HEAP;
+    if (index < size) {
+        siftUp(index);
+        siftDown(index);
+    }
+}
+
+/**
+ * @brief Removes and returns the cell with the lowest key.
+ * @return The cell index.
+ */
+uint16_t CellHeap::pop() {
+    uint16_t cell = heap[0];
+    remove(cell);
+    return cell;
+}
+
+/**
+ * @brief Octile distance between two cells, in cells. Never overestimates the cost on an 8-connected grid.
+ */
+float PathPlanner::heuristic(uint16_t a, uint16_t b) const {
+    float dx = std::abs(a % OccupancyGrid::WIDTH - b % OccupancyGrid::WIDTH);
+    float dy = std::abs(a / OccupancyGrid::WIDTH - b / OccupancyGrid::WIDTH);
+    return std::max(dx, dy) + ((float)M_SQRT2 - 1) * std::min(dx, dy);
+}
+
+/**
+ * @brief Get the cells next to a cell, including diagonally, and the costs of moving between the cell and each of them.
+ * Moves into an occupied cell, and diagonal moves past the corner of an occupied cell, are blocked and cost infinity.
+ * Moves out of an occupied cell are allowed, so a robot that starts inside the inflated area of an obstacle can still leave it.
+ * @param cell The cell index.
+ * @param cells Filled with the cells next to it that are inside the grid.
+ * @param costsOut Filled with the cost of moving from the cell to each of them.
+ * @param costsIn Filled with the cost of moving from each of them to the cell.
+ * @return The number of cells found (up to 8).
+ */
+int PathPlanner::moves(uint16_t cell, std::array<uint16_t, 8> &cells, std::array<float, 8> &costsOut, std::array<float, 8> &costsIn) const {
+    int column = cell % OccupancyGrid::WIDTH;
+    int row = cell / OccupancyGrid::WIDTH;
+
+    // Every cost depends only on the 3 x 3 block around the cell, so it is read once. Cells outside the grid count as occupied
+    bool block[3][3];
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int x = column + dx;
+            int y = row + dy;
+            bool inside = x >= 0 && x < OccupancyGrid::WIDTH && y >= 0 && y < OccupancyGrid::HEIGHT;
+            block[dy + 1][dx + 1] = !inside || occupied[y * OccupancyGrid::WIDTH + x];
+        }
+    }
+
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int x = column + dx;
+            int y = row + dy;
+            if ((dx == 0 && dy == 0) || x < 0 || x >= OccupancyGrid::WIDTH || y < 0 || y >= OccupancyGrid::HEIGHT) {
+                continue;
+            }
+            // A diagonal move passes the corner shared by the cell one step across and the cell one step along,
+            // which is the same corner in both directions
+            bool straight = dx == 0 || dy == 0;
+            bool cornerClear = straight || (!block[1][dx + 1] && !block[dy + 1][1]);
+            float cost = straight ? 1 : (float)M_SQRT2;
+            cells[count] = y * OccupancyGrid::WIDTH + x;
+            costsOut[count] = cornerClear && !block[dy + 1][dx + 1] ? cost : INFINITE_COST;
+            costsIn[count] = cornerClear && !block[1][1] ? cost : INFINITE_COST;
+            count++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Plans a path from scratch with A*.
+ * @param startX The x coordinate of the start (in inches).
+ * @param startY The y coordinate of the start (in inches).
+ * @param goalX The x coordinate of the goal (in inches).
+ * @param goalY The y coordinate of the goal (in inches).
+ * @param spacing The distance between waypoints in inches.
+ * @param velocity The target motor speed at every waypoint (0 - 127).
+ * @return The waypoints, or an empty path if the goal is occupied or can't be reached.
+ */
+std::vector<Waypoint> PathPlanner::plan(double startX, double startY, double goalX, double goalY, double spacing, double velocity) {
+    // The search state is shared with the incremental mode
+    incrementalGoal = OccupancyGrid::NO_CELL;
+
+    uint16_t start = grid->cellAt(startX, startY);
+    uint16_t goal = grid->cellAt(goalX, goalY);
+    if (start == OccupancyGrid::NO_CELL || goal == OccupancyGrid::NO_CELL || grid->isOccupied(goal)) {
+        return {};
+    }
+
+    refreshOccupancy();
+    g.fill(INFINITE_COST);
+    open.clear();
+    g[start] = 0;
+    parents[start] = OccupancyGrid::NO_CELL;
+    open.push(start, {heuristic(start, goal), heuristic(start, goal)});
+
+    // The heuristic is consistent, so each cell's cost is final when it is popped and no closed list is needed
+    std::array<uint16_t, 8> cells;
+    std::array<float, 8> costsOut;
+    std::array<float, 8> costsIn;
+    while (!open.empty()) {
+        uint16_t cell = open.pop();
+        if (cell == goal) {
+            break;
+        }
+
+        int count = moves(cell, cells, costsOut, costsIn);
+        for (int i = 0; i < count; i++) {
+            uint16_t next = cells[i];
+            float cost = g[cell] + costsOut[i];
+            if (cost < g[next]) {
+                g[next] = cost;
+                parents[next] = cell;
+                float h = heuristic(next, goal);
+                open.push(next, {cost + h, h});
+            }
+        }
+    }
+
+    if (g[goal] == INFINITE_COST) {
+        return {};
+    }
+
+    chain.clear();
+    for (uint16_t cell = goal; cell != OccupancyGrid::NO_CELL; cell = parents[cell]) {
+        chain.push_back(cell);
+    }
+    std::reverse(chain.begin(), chain.end());
+    return buildPath(startX, startY, goalX, goalY, spacing, velocity);
+}
+
+/**
+ * @brief Copies every cell's occupancy from the grid.
+ */
+void PathPlanner::refreshOccupancy() {
+    for (size_t cell = 0; cell < OccupancyGrid::CELLS; cell++) {
+        occupied[cell] = grid->isOccupied((uint16_t)cell);
+    }
+}
+
+/**
+ * @brief Clears the incremental search, leaving only the goal queued, so the next search starts from scratch.
+ */
+void PathPlanner::resetIncremental() {
+    g.fill(INFINITE_COST);
+    rhs.fill(INFINITE_COST);
+    open.clear();
+    keyModifier = 0;
+    rhs[incrementalGoal] = 0;
+    open.push(incrementalGoal, {heuristic(incrementalStart, incrementalGoal), 0});
+}
+
+PlannerKey PathPlanner::calculateKey(uint16_t cell) const {
+    float cost = std::min(g[cell], rhs[cell]);
+    return {cost + heuristic(incrementalStart, cell) + keyModifier, cost};
+}
+
+void PathPlanner::updateVertex(uint16_t cell) {
+    if (cell != incrementalGoal) {
+        // The search runs backwards from the goal, so a cell's cost is the cheapest move towards the goal
+        std::array<uint16_t, 8> cells;
+        std::array<float, 8> costsOut;
+        std::array<float, 8> costsIn;
+        int count = moves(cell, cells, costsOut, costsIn);
+        float best = INFINITE_COST;
+        for (int i = 0; i < count; i++) {
+            best = std::min(best, costsOut[i] + g[cells[i]]);
+        }
+        rhs[cell] = best;
+    }
+
+    updateQueue(cell);
+}
+
+void PathPlanner::updateQueue(uint16_t cell) {
+    if (g[cell] != rhs[cell]) {
+        open.push(cell, calculateKey(cell));
+    } else {
+        open.remove(cell);
+    }
+}
+
+void PathPlanner::computeShortestPath() {
+    std::array<uint16_t, 8> cells;
+    std::array<float, 8> costsOut;
+    std::array<float, 8> costsIn;
+    while (!open.empty() && (open.topKey() < calculateKey(incrementalStart) || rhs[incrementalStart] != g[incrementalStart])) {
+        uint16_t cell = open.top();
+        PlannerKey oldKey = open.topKey();
+        PlannerKey newKey = calculateKey(cell);
+
+        if (oldKey < newKey) {
+            open.push(cell, newKey);
+            continue;
+        }
+
+        open.remove(cell);
+        int count = moves(cell, cells, costsOut, costsIn);
+        if (g[cell] > rhs[cell]) {
+            // The cell's cost went down, so it can only improve its neighbors. Only the move through it needs checking,
+            // instead of every neighbor rescanning all of its own neighbors
+            g[cell] = rhs[cell];
+            for (int i = 0; i < count; i++) {
+                uint16_t next = cells[i];
+                float cost = costsIn[i] + g[cell];
+                if (next != incrementalGoal && cost < rhs[next]) {
+                    // A neighbor whose cost didn't change is already queued correctly, so only improved ones are touched
+                    rhs[next] = cost;
+                    updateQueue(next);
+                }
+            }
+        } else {
+            // The cell's cost went up, so only the neighbors whose best move went through it need a full rescan
+            float oldCost = g[cell];
+            g[cell] = INFINITE_COST;
+            updateQueue(cell); // A cell's rhs doesn't depend on its own cost, so it needs no rescan
+            for (int i = 0; i < count; i++) {
+                uint16_t next = cells[i];
+                if (next != incrementalGoal && rhs[next] == costsIn[i] + oldCost) {
+                    updateVertex(next);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Starts incremental planning towards a goal with D* Lite. Clears the grid's recorded changes.
+ * @param startX The x coordinate of the start (in inches).
+ * @param startY The y coordinate of the start (in inches).
+ * @param goalX The x coordinate of the goal (in inches).
+ * @param goalY The y coordinate of the goal (in inches).
+ * @param spacing The distance between waypoints in inches.
+ * @param velocity The target motor speed at every waypoint (0 - 127).
+ * @return The waypoints, or an empty path if the goal is occupied or can't be reached.
+ */
+std::vector<Waypoint> PathPlanner::startIncremental(double startX, double startY, double goalX, double goalY, double spacing, double velocity) {
+    grid->clearChanges();
+
+    incrementalStart = grid->cellAt(startX, startY);
+    incrementalGoal = grid->cellAt(goalX, goalY);
+    if (incrementalStart == OccupancyGrid::NO_CELL || incrementalGoal == OccupancyGrid::NO_CELL) {
+        incrementalGoal = OccupancyGrid::NO_CELL;
+        return {};
+    }
+    this->goalX = goalX;
+    this->goalY = goalY;
+
+    refreshOccupancy();
+    pending.fill(false);
+    resetIncremental();
+    return replan(startX, startY, spacing, velocity);
+}
+
+/**
+ * @brief Repairs the incremental plan after the robot has moved or the grid has changed, then clears the grid's recorded changes.
+ * Searches from scratch instead if a change blocks the current path, or too many cells changed to track.
+ * @param startX The robot's current x coordinate (in inches).
+ * @param startY The robot's current y coordinate (in inches).
+ * @param spacing The distance between waypoints in inches.
+ * @param velocity The target motor speed at every waypoint (0 - 127).
+ * @return The waypoints, or an empty path if the goal is occupied or can't be reached.
+ */
+std::vector<Waypoint> PathPlanner::replan(double startX, double startY, double spacing, double velocity) {
+    uint16_t start = grid->cellAt(startX, startY);
+    if (incrementalGoal == OccupancyGrid::NO_CELL || start == OccupancyGrid::NO_CELL) {
+        return {};
+    }
+
+    size_t changeCount;
+    const uint16_t *changes = grid->getChanges(changeCount);
+    if (!changes) {
+        return startIncremental(startX, startY, goalX, goalY, spacing, velocity);
+    }
+
+    // Moving the start lowers every heuristic by up to the distance moved, which the key modifier makes up for
+    keyModifier += heuristic(incrementalStart, start);
+    incrementalStart = start;
+
+    // The grid records every switch, so an obstacle that is cleared and added back records its cells twice even where
+    // nothing moved. Only cells that differ from the last repair are handled, and each affected cell is updated once.
+    // A changed cell affects the moves into it and the diagonal moves past its corners, which all start next to it
+    std::array<uint16_t, 8> cells;
+    std::array<float, 8> costsOut;
+    std::array<float, 8> costsIn;
+    updates.clear();
+    for (size_t i = 0; i < changeCount; i++) {
+        uint16_t changed = changes[i];
+        bool occupiedNow = grid->isOccupied(changed);
+        if (occupied[changed] == occupiedNow) {
+            continue;
+        }
+        occupied[changed] = occupiedNow;
+        int count = moves(changed, cells, costsOut, costsIn);
+        for (int j = 0; j < count; j++) {
+            if (!pending[cells[j]]) {
+                pending[cells[j]] = true;
+                updates.push_back(cells[j]);
+            }
+        }
+    }
+    grid->clearChanges();
+
+    // The chain still holds the last path. If a change blocks it, the path's cost goes up, and so does the cost of every cell
+    // whose best route shared it. Raising and then lowering all of those takes several times longer than searching again,
+    // so the search starts over instead. The robot's own cell may be occupied, so it is skipped
+    bool pathBlocked = false;
+    for (size_t i = 1; i < chain.size() && !pathBlocked; i++) {
+        pathBlocked = occupied[chain[i]];
+    }
+    for (uint16_t cell : updates) {
+        pending[cell] = false;
+        if (!pathBlocked) {
+            updateVertex(cell);
+        }
+    }
+    if (pathBlocked) {
+        resetIncremental();
+    }
+
+    computeShortestPath();
+    if (g[start] == INFINITE_COST || grid->isOccupied(incrementalGoal)) {
+        return {};
+    }
+
+    // Walk downhill from the start to the goal. The chain is kept for the next repair
+    chain.clear();
+    chain.push_back(start);
+    uint16_t cell = start;
+    while (cell != incrementalGoal && chain.size() < OccupancyGrid::CELLS) {
+        int count = moves(cell, cells, costsOut, costsIn);
+        uint16_t next = cell;
+        float best = INFINITE_COST;
+        for (int i = 0; i < count; i++) {
+            float cost = costsOut[i] + g[cells[i]];
+            if (cost < best) {
+                best = cost;
+                next = cells[i];
+            }
+        }
+        if (next == cell) {
+            return {};
+        }
+        cell = next;
+        chain.push_back(cell);
+    }
+    return buildPath(startX, startY, goalX, goalY, spacing, velocity);
+}
+
+/**
+ * @brief Smooths the chain of cells and samples it into waypoints.
+ * @param startX The robot's actual x coordinate, used as the first point.
+ * @param startY The robot's actual y coordinate, used as the first point.
+ * @param goalX The goal's actual x coordinate, used as the last point.
+ * @param goalY The goal's actual y coordinate, used as the last point.
+ * @param spacing The distance between waypoints in inches.
+ * @param velocity The target motor speed at every waypoint (0 - 127).
+ */
+std::vector<Waypoint> PathPlanner::buildPath(double startX, double startY, double goalX, double goalY, double spacing, double velocity) {
+    // The points are the actual start, the centers of the cells in between, and the actual goal
+    size_t pointCount = std::max(chain.size(), (size_t)2);
+    auto point = [&](size_t i) -> Waypoint {
+        if (i == 0) {
+            return {startX, startY, velocity};
+        }
+        if (i + 1 == pointCount) {
+            return {goalX, goalY, velocity};
+        }
+        return {grid->cellX(chain[i]), grid->cellY(chain[i]), velocity};
+    };
+
+    // Pull the path tight: from each corner, skip ahead as far as the straight line stays clear.
+    // The robot may start inside the inflated area of an obstacle, so the first segment is always kept
+    corners.clear();
+    corners.push_back(point(0));
+    size_t anchor = 0;
+    if (grid->isOccupied(startX, startY) && pointCount > 2) {
+        anchor = 1;
+        corners.push_back(point(1));
+    }
+    while (anchor + 1 < pointCount) {
+        Waypoint from = point(anchor);
+        size_t next = anchor + 1;
+        while (next + 1 < pointCount) {
+            Waypoint to = point(next + 1);
+            if (!grid->isLineClear(from.x, from.y, to.x, to.y)) {
+                break;
+            }
+            next++;
+        }
+        corners.push_back(point(next));
+        anchor = next;
+    }
+
+    if (spacing <= 0) {
+        return corners;
+    }
+
+    // Sample the corners into evenly spaced waypoints
+    size_t waypointCount = 1;
+    for (size_t i = 1; i < corners.size(); i++) {
+        double length = std::hypot(corners[i].x - corners[i - 1].x, corners[i].y - corners[i - 1].y);
+        waypointCount += std::max(1, (int)std::ceil(length / spacing));
+    }
+    std::vector<Waypoint> path;
+    path.reserve(waypointCount);
+    path.push_back(corners[0]);
+    for (size_t i = 1; i < corners.size(); i++) {
+        double dx = corners[i].x - corners[i - 1].x;
+        double dy = corners[i].y - corners[i - 1].y;
+        int steps = std::max(1, (int)std::ceil(std::hypot(dx, dy) / spacing));
+        for (int step = 1; step <= steps; step++) {
+            double t = (double)step / steps;
+            path.push_back({corners[i - 1].x + t * dx, corners[i - 1].y + t * dy, velocity});
+        }
+    }
+    return path;
+}
@@ -57,6 +57,24 @@ void PIDController::setSmallErrorRange(double range) {
     smallErrorRange = range;
 }
 
+/**
+ * Gets the large error range for the PID controller.
+ * 
+ * @return the large error range
+ */
+double PIDController::getLargeErrorRange() {
+    return largeErrorRange;
+}
+
+/**
+ * Gets the small error range for the PID controller.
+ * 
+ * @return the small error range
+ */
+double PIDController::getSmallErrorRange() {
+    return smallErrorRange;
+}
+
 /**
  * Sets the output limits for the PID controller.
  * If these values are not 0, the calculate() method will automatically clamp the output to be within these limits.
@@ -181,13 +199,17 @@ double PIDController::getSetpoint() {
 
 /**
  * Resets the PID controller.
- * This sets the accumulated error, error, and previous error to 0.
+ * This sets the accumulated error, error, previous error, and previous output to 0 and restarts the loop timer.
  * It is highly recommended to call this method before starting a new loop to ensure accurate results.
  */
 void PIDController::reset() {
     accumulatedError = 0.0;
     error = 0.0;
     previousError = 0.0;
+    previousOutput = 0.0;
+
+    currentTime = pros::millis();
+    previousTime = currentTime;
 }
 
 /**
@@ -206,9 +228,10 @@ double PIDController::calculate(double measurement, double setpoint) {
     int elapsedTime = currentTime - previousTime;
 
     // Calculate the output of the PID controller
+    // The D term is skipped when no time has passed (e.g. the first call after a reset)
     double output = kP * error +                                  // P term
                     (kI * accumulatedError * elapsedTime) +       // I term
-                    ((error - previousError) * kD / elapsedTime); // D term
+                    (elapsedTime > 0 ? (error - previousError) * kD / elapsedTime : 0); // D term
 
     // Clamp the output
     if (minOutput != 0.0) {
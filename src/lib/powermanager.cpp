@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cstdlib>
+#include "lib/powermanager.hpp"
+
+/**
+ * @brief Registers a motor group as a consumer.
+ * @param motors The motor group.
+ * @param sampleGroup The group's index in the sampler's records, as returned by MotorSampler::addMotors.
+ * @param priority Higher priority consumers are given current first.
+ * @param active Returns true while the consumer needs full power. Leave empty to always give it full power when the budget allows.
+ * @return The consumer's id, or -1 if MAX_CONSUMERS consumers have already been added.
+ */
+int PowerManager::add(pros::MotorGroup *motors, int sampleGroup, int priority, std::function<bool()> active) {
+    if (motors == nullptr || consumerCount == MAX_CONSUMERS) {
+        return -1;
+    }
+
+    size_t id = consumerCount++;
+    Consumer &consumer = consumers[id];
+    consumer.motors = motors;
+    consumer.sampleGroup = sampleGroup;
+    consumer.priority = priority;
+    consumer.active = active;
+    consumer.motorCount = std::max((int32_t)motors->size(), (int32_t)1);
+    consumer.limit = 0;
+
+    // Insert into the priority order after every consumer with the same or higher priority
+    size_t position = id;
+    while (position > 0 && consumers[order[position - 1]].priority < priority) {
+        order[position] = order[position - 1];
+        position--;
+    }
+    order[position] = id;
+    return id;
+}
+
+/**
+ * @brief Registers every motor group of a drivetrain as consumers with the same priority.
+ * @param drivetrain The drivetrain. Its groups are found in the sampler by their indexes in getMotors().
+ * @param priority Higher priority consumers are given current first.
+ * @param active Returns true while the drivetrain needs full power.
+ */
+void PowerManager::addDrivetrain(Drivetrain *drivetrain, int priority, std::function<bool()> active) {
+    if (drivetrain == nullptr) {
+        return;
+    }
+    std::array<pros::MotorGroup*, Drivetrain::MAX_MOTOR_GROUPS> groups;
+    size_t groupCount = drivetrain->getMotors(groups);
+    for (size_t group = 0; group < groupCount; group++) {
+        add(groups[group], group, priority, active);
+    }
+}
+
+/**
+ * @brief Reallocates the current limits from the latest sample. Limits are only sent when they change.
+ */
+void PowerManager::update() {
+    MotorRecord record;
+    if (sampler == nullptr || consumerCount == 0 || !sampler->getLatest(record)) {
+        return;
+    }
+
+    // Total current each sampled group is drawing. Group indexes are stored in 4 bits, so there are at most 16
+    std::array<int32_t, 16> groupDraws = {};
+    for (size_t i = 0; i < record.motorCount; i++) {
+        groupDraws[record.motors[i].getGroup() % groupDraws.size()] += std::abs(record.motors[i].currentDraw);
+    }
+
+    // Work out each consumer's most, least and wanted current for the whole group
+    std::array<int32_t, MAX_CONSUMERS> maximums;
+    std::array<int32_t, MAX_CONSUMERS> demands;
+    std::array<int32_t, MAX_CONSUMERS> grants;
+    int64_t totalMinimum = 0;
+    for (size_t i = 0; i < consumerCount; i++) {
+        const Consumer &consumer = consumers[i];
+        int32_t perMotorMax = MAX_MOTOR_CURRENT;
+        if (thermalGovernor != nullptr && consumer.sampleGroup >= 0 && consumer.sampleGroup < (int)Drivetrain::MAX_MOTOR_GROUPS) {
+            int32_t thermalLimit = thermalGovernor->getCurrentLimit(consumer.sampleGroup);
+            if (thermalLimit > 0) {
+                perMotorMax = std::min(perMotorMax, thermalLimit);
+            }
+        }
+        maximums[i] = perMotorMax * consumer.motorCount;
+        grants[i] = std::min(minCurrent * consumer.motorCount, maximums[i]);
+        totalMinimum += grants[i];
+
+        bool fullPower = !consumer.active || consumer.active();
+        int32_t draw = consumer.sampleGroup >= 0 ? groupDraws[consumer.sampleGroup % groupDraws.size()] : 0;
+        demands[i] = fullPower ? maximums[i] : std::clamp((int32_t)(draw * headroom), grants[i], maximums[i]);
+    }
+
+    // If even the minimums don't fit, shrink them all together
+    int64_t remaining = budget - totalMinimum;
+    if (remaining < 0) {
+        for (size_t i = 0; i < consumerCount; i++) {
+            grants[i] = totalMinimum > 0 ? grants[i] * budget / totalMinimum : 0;
+        }
+        remaining = 0;
+    }
+
+    // Meet demands in priority order, then hand out what is left as headroom in the same order
+    for (size_t i = 0; i < consumerCount && remaining > 0; i++) {
+        size_t id = order[i];
+        int32_t extra = (int32_t)std::min<int64_t>(std::max(demands[id] - grants[id], 0), remaining);
+        grants[id] += extra;
+        remaining -= extra;
+    }
+    for (size_t i = 0; i < consumerCount && remaining > 0; i++) {
+        size_t id = order[i];
+        int32_t extra = (int32_t)std::min<int64_t>(maximums[id] - grants[id], remaining);
+        grants[id] += extra;
+        remaining -= extra;
+    }
+
+    // Only send limits that moved noticeably, so the motors aren't flooded with commands
+    const int32_t minChange = 50; // in milliamps
+    for (size_t i = 0; i < consumerCount; i++) {
+        Consumer &consumer = consumers[i];
+        int32_t limit = grants[i] / consumer.motorCount;
+        if (consumer.limit == 0 || std::abs(limit - consumer.limit) >= minChange) {
+            consumer.motors->set_current_limit_all(limit);
+            consumer.limit = limit;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include <cmath>
+#include "lib/purepursuit.hpp"
+
+/**
+ * @brief Construct a new PurePursuit object.
+ * @param path The waypoints to follow, spaced closely together (a few inches apart).
+ */
+PurePursuit::PurePursuit(std::vector<Waypoint> path) : path(path) {
+    reset();
+}
+
+/**
+ * @brief Restarts the search from the beginning of the path.
+ */
+void PurePursuit::reset() {
+    closestIndex = 0;
+    lookaheadIndex = 0;
+    lookaheadPoint = path.empty() ? Waypoint{0, 0, 0} : path[0];
+}
+
+/**
+ * @brief Updates the closest and lookahead points for the robot's current pose.
+ * @param pose The current pose of the robot.
+ * @param lookahead The lookahead distance in inches.
+ */
+void PurePursuit::update(Pose pose, double lookahead) {
+    if (path.empty()) {
+        return;
+    }
+    updateClosest(pose);
+    updateLookahead(pose, lookahead);
+}
+
+/**
+ * @brief Advances the closest waypoint index until the next waypoint is no closer to the robot.
+ * @param pose The current pose of the robot.
+ */
+void PurePursuit::updateClosest(Pose pose) {
+    Pose current(path[closestIndex].x, path[closestIndex].y, 0);
+    double closestDistance = pose.distanceTo(current);
+
+    while (closestIndex + 1 < path.size()) {
+        Pose next(path[closestIndex + 1].x, path[closestIndex + 1].y, 0);
+        double nextDistance = pose.distanceTo(next);
+        if (nextDistance > closestDistance) {
+            break;
+        }
+        closestIndex++;
+        closestDistance = nextDistance;
+    }
+}
+
+/**
+ * @brief Advances the lookahead point to the furthest intersection of the lookahead circle with the path.
+ * @param pose The current pose of the robot.
+ * @param lookahead The lookahead distance in inches.
+ */
+void PurePursuit::updateLookahead(Pose pose, double lookahead) {
+    // The last waypoint is used as the lookahead point once it is inside the lookahead circle
+    const Waypoint &last = path.back();
+    if (pose.distanceTo(Pose(last.x, last.y, 0)) <= lookahead) {
+        lookaheadIndex = path.size() - 1;
+        lookaheadPoint = last;
+        return;
+    }
+
+    // Resume from the segment of the previous lookahead point. The lookahead point never moves backwards.
+    for (size_t i = (size_t)lookaheadIndex; i + 1 < path.size(); i++) {
+        const Waypoint &start = path[i];
+        const Waypoint &end = path[i + 1];
+
+        // Once the path has left the lookahead circle past the robot, there is nothing further along to find
+        if (i > closestIndex && pose.distanceTo(Pose(start.x, start.y, 0)) > lookahead) {
+            break;
+        }
+
+        // Solve |start + t * d - pose| = lookahead for t
+        double dx = end.x - start.x;
+        double dy = end.y - start.y;
+        double fx = start.x - pose.getX();
+        double fy = start.y - pose.getY();
+
+        double a = dx * dx + dy * dy;
+        double b = 2 * (fx * dx + fy * dy);
+        double c = fx * fx + fy * fy - lookahead * lookahead;
+        double discriminant = b * b - 4 * a * c;
+        if (a == 0 || discriminant < 0) {
+            continue;
+        }
+
+        // The larger root is the intersection further along the segment
+        double t = (-b + std::sqrt(discriminant)) / (2 * a);
+        if (t < 0 || t > 1 || i + t < lookaheadIndex) {
+            continue;
+        }
+
+        lookaheadIndex = i + t;
+        lookaheadPoint = {start.x + t * dx, start.y + t * dy, start.velocity + t * (end.velocity - start.velocity)};
+        return;
+    }
+}
+
+/**
+ * @brief Get the waypoint closest to the robot, as of the last update.
+ * @return The closest waypoint.
+ */
+Waypoint PurePursuit::getClosest() const {
+    if (path.empty()) {
+        return {0, 0, 0};
+    }
+    return path[closestIndex];
+}
+
+/**
+ * @brief Returns whether the robot has reached the end of the path.
+ * @param pose The current pose of the robot.
+ * @param endDistance How close the robot has to be to the last waypoint in inches.
+ * @return True if the closest point is the last waypoint and the robot is within endDistance of it.
+ */
+bool PurePursuit::isFinished(Pose pose, double endDistance) {
+    if (path.empty()) {
+        return true;
+    }
+    const Waypoint &last = path.back();
+    return closestIndex + 1 == path.size() && pose.distanceTo(Pose(last.x, last.y, 0)) <= endDistance;
+}
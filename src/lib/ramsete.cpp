@@ -0,0 +1,32 @@
+#include <cmath>
+#include "lib/ramsete.hpp"
+#include "util/angle.hpp"
+
+/**
+ * Calculates the velocities that bring the robot back onto the trajectory.
+ * 
+ * @param current the current pose of the robot
+ * @param reference the pose the robot should be at
+ * @param linearVelocity the linear velocity from the trajectory in inches per second
+ * @param angularVelocity the angular velocity from the trajectory in radians per second
+ * @return the corrected linear and angular velocity
+ */
+ChassisVelocity Ramsete::calculate(Pose current, Pose reference, double linearVelocity, double angularVelocity) const {
+    // Error in the robot's frame. Forward is (-sin(theta), cos(theta)) and the heading increases towards (-cos(theta), -sin(theta))
+    double dx = reference.getX() - current.getX();
+    double dy = reference.getY() - current.getY();
+    double theta = current.getTheta();
+    double forwardError = -dx * sin(theta) + dy * cos(theta);
+    double sideError = -dx * cos(theta) - dy * sin(theta);
+    double headingError = angleError(reference.getTheta(), theta);
+
+    double k = 2 * zeta * std::sqrt(angularVelocity * angularVelocity + b * linearVelocity * linearVelocity);
+
+    // sin(x) / x, which tends to 1 as x approaches 0
+    double sinc = std::abs(headingError) < 1e-6 ? 1 : sin(headingError) / headingError;
+
+    ChassisVelocity output;
+    output.linear = linearVelocity * cos(headingError) + k * forwardError;
+    output.angular = angularVelocity + k * headingError + b * linearVelocity * sinc * sideError;
+    return output;
+}
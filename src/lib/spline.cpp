@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <cmath>
+#include "lib/spline.hpp"
+
+SplineSegment::SplineSegment(std::array<double, 6> xCoeffs, std::array<double, 6> yCoeffs)
+: xCoeffs(xCoeffs), yCoeffs(yCoeffs) {
+    // Integrate the speed over each table interval with Simpson's rule
+    auto speed = [this](double u) {
+        Pose derivative = evaluate(u, 1);
+        return std::hypot(derivative.getX(), derivative.getY());
+    };
+
+    arcLengths[0] = 0;
+    for (size_t i = 0; i < TABLE_SIZE; i++) {
+        double u0 = (double)i / TABLE_SIZE;
+        double u1 = (double)(i + 1) / TABLE_SIZE;
+        double intervalLength = (u1 - u0) / 6 * (speed(u0) + 4 * speed((u0 + u1) / 2) + speed(u1));
+        arcLengths[i + 1] = arcLengths[i] + intervalLength;
+    }
+}
+
+/**
+ * @brief Evaluates the derivatives of the polynomial at u.
+ * @param u The spline parameter (0 - 1).
+ * @param order The derivative to evaluate (0 for the position).
+ * @return The x and y derivatives as a Pose (theta is unused).
+ */
+Pose SplineSegment::evaluate(double u, int order) const {
+    double x = 0;
+    double y = 0;
+
+    // Horner's method on the differentiated coefficients
+    for (int i = 5; i >= order; i--) {
+        double factor = 1;
+        for (int k = 0; k < order; k++) {
+            factor *= i - k;
+        }
+        x = x * u + xCoeffs[i] * factor;
+        y = y * u + yCoeffs[i] * factor;
+    }
+    return Pose(x, y, 0);
+}
+
+/**
+ * @brief Creates a cubic Hermite segment that leaves start and arrives at end along their headings.
+ * @param start The start point and heading.
+ * @param end The end point and heading.
+ * @param tangentScale The tangent lengths as a multiple of the distance between the points. Higher values make wider curves.
+ * @return The segment.
+ */
+SplineSegment SplineSegment::cubicHermite(Pose start, Pose end, double tangentScale) {
+    double scale = start.distanceTo(end) * tangentScale;
+    double p0[2] = {start.getX(), start.getY()};
+    double p1[2] = {end.getX(), end.getY()};
+    double m0[2] = {-sin(start.getTheta()) * scale, cos(start.getTheta()) * scale};
+    double m1[2] = {-sin(end.getTheta()) * scale, cos(end.getTheta()) * scale};
+
+    std::array<double, 6> coeffs[2];
+    for (int i = 0; i < 2; i++) {
+        coeffs[i] = {p0[i],
+                     m0[i],
+                     -3 * p0[i] - 2 * m0[i] + 3 * p1[i] - m1[i],
+                     2 * p0[i] + m0[i] - 2 * p1[i] + m1[i],
+                     0,
+                     0};
+    }
+    return SplineSegment(coeffs[0], coeffs[1]);
+}
+
+/**
+ * @brief Creates a quintic Hermite segment that leaves start and arrives at end along their headings.
+ * The second derivative is 0 at both ends, so segments joined together have continuous curvature.
+ * @param start The start point and heading.
+ * @param end The end point and heading.
+ * @param tangentScale The tangent lengths as a multiple of the distance between the points. Higher values make wider curves.
+ * @return The segment.
+ */
+SplineSegment SplineSegment::quinticHermite(Pose start, Pose end, double tangentScale) {
+    double scale = start.distanceTo(end) * tangentScale;
+    double p0[2] = {start.getX(), start.getY()};
+    double p1[2] = {end.getX(), end.getY()};
+    double m0[2] = {-sin(start.getTheta()) * scale, cos(start.getTheta()) * scale};
+    double m1[2] = {-sin(end.getTheta()) * scale, cos(end.getTheta()) * scale};
+
+    std::array<double, 6> coeffs[2];
+    for (int i = 0; i < 2; i++) {
+        coeffs[i] = {p0[i],
+                     m0[i],
+                     0,
+                     -10 * p0[i] - 6 * m0[i] - 4 * m1[i] + 10 * p1[i],
+                     15 * p0[i] + 8 * m0[i] + 7 * m1[i] - 15 * p1[i],
+                     -6 * p0[i] - 3 * m0[i] - 3 * m1[i] + 6 * p1[i]};
+    }
+    return SplineSegment(coeffs[0], coeffs[1]);
+}
+
+/**
+ * @brief Creates a cubic Bezier segment from its four control points. The control point headings are unused.
+ * @param p0 The start point.
+ * @param p1 The first control point.
+ * @param p2 The second control point.
+ * @param p3 The end point.
+ * @return The segment.
+ */
+SplineSegment SplineSegment::cubicBezier(Pose p0, Pose p1, Pose p2, Pose p3) {
+    double points[4][2] = {{p0.getX(), p0.getY()}, {p1.getX(), p1.getY()}, {p2.getX(), p2.getY()}, {p3.getX(), p3.getY()}};
+
+    std::array<double, 6> coeffs[2];
+    for (int i = 0; i < 2; i++) {
+        coeffs[i] = {points[0][i],
+                     3 * (points[1][i] - points[0][i]),
+                     3 * (points[2][i] - 2 * points[1][i] + points[0][i]),
+                     points[3][i] - 3 * points[2][i] + 3 * points[1][i] - points[0][i],
+                     0,
+                     0};
+    }
+    return SplineSegment(coeffs[0], coeffs[1]);
+}
+
+/**
+ * @brief Get the point at a parameter value.
+ * @param u The spline parameter (0 - 1).
+ * @return The point, heading, and curvature at u.
+ */
+SplinePoint SplineSegment::pointAt(double u) const {
+    Pose position = evaluate(u, 0);
+    Pose first = evaluate(u, 1);
+    Pose second = evaluate(u, 2);
+
+    double dx = first.getX();
+    double dy = first.getY();
+    double speed = std::hypot(dx, dy);
+
+    SplinePoint point;
+    point.pose = Pose(position.getX(), position.getY(), std::atan2(-dx, dy));
+    point.curvature = speed == 0 ? 0 : (dx * second.getY() - dy * second.getX()) / (speed * speed * speed);
+    return point;
+}
+
+/**
+ * @brief Converts a distance along the segment to a parameter value using the arc length table.
+ * The search starts from tableIndex and moves it to the interval containing the distance.
+ * @param distance The distance along the segment in inches.
+ * @param tableIndex The table interval of the last lookup, updated to the interval of this lookup.
+ * @return The spline parameter (0 - 1).
+ */
+double SplineSegment::parameterAt(double distance, size_t &tableIndex) const {
+    distance = std::clamp(distance, 0.0, getLength());
+    tableIndex = std::min(tableIndex, TABLE_SIZE - 1);
+
+    while (tableIndex + 1 < TABLE_SIZE && arcLengths[tableIndex + 1] < distance) {
+        tableIndex++;
+    }
+    while (tableIndex > 0 && arcLengths[tableIndex] > distance) {
+        tableIndex--;
+    }
+
+    // Interpolate within the interval
+    double intervalLength = arcLengths[tableIndex + 1] - arcLengths[tableIndex];
+    double fraction = intervalLength > 0 ? (distance - arcLengths[tableIndex]) / intervalLength : 0;
+    return (tableIndex + fraction) / TABLE_SIZE;
+}
+
+/**
+ * @brief Construct a new Spline object.
+ * @param segments The segments of the spline, in order.
+ */
+Spline::Spline(std::vector<SplineSegment> segments) : segments(segments) {
+    startDistances.reserve(segments.size());
+    for (const SplineSegment &segment : segments) {
+        startDistances.push_back(length);
+        length += segment.getLength();
+    }
+}
+
+/**
+ * @brief Construct a new Spline object through a list of poses, joining them with cubic or quintic Hermite segments.
+ * @param waypoints The poses to pass through, in order.
+ * @param quintic If true, quintic Hermite segments are used for continuous curvature.
+ */
+Spline::Spline(std::vector<Pose> waypoints, bool quintic) {
+    for (size_t i = 0; i + 1 < waypoints.size(); i++) {
+        if (quintic) {
+            segments.push_back(SplineSegment::quinticHermite(waypoints[i], waypoints[i + 1]));
+        } else {
+            segments.push_back(SplineSegment::cubicHermite(waypoints[i], waypoints[i + 1]));
+        }
+        startDistances.push_back(length);
+        length += segments.back().getLength();
+    }
+}
+
+/**
+ * @brief Get the point at a distance along the spline. Distances outside the spline are clamped.
+ * @param distance The distance along the spline in inches.
+ * @param cursor The cursor of the last lookup, updated to this lookup.
+ * @return The point, heading, and curvature at that distance.
+ */
+SplinePoint Spline::pointAt(double distance, SplineCursor &cursor) const {
+    if (segments.empty()) {
+        return SplinePoint();
+    }
+
+    distance = std::clamp(distance, 0.0, length);
+    size_t previousSegment = cursor.segment = std::min(cursor.segment, segments.size() - 1);
+
+    while (cursor.segment + 1 < segments.size() && startDistances[cursor.segment + 1] <= distance) {
+        cursor.segment++;
+    }
+    while (cursor.segment > 0 && startDistances[cursor.segment] > distance) {
+        cursor.segment--;
+    }
+
+    // The table position only carries over within the same segment
+    if (cursor.segment != previousSegment) {
+        cursor.tableIndex = cursor.segment > previousSegment ? 0 : SplineSegment::TABLE_SIZE - 1;
+    }
+
+    const SplineSegment &segment = segments[cursor.segment];
+    double u = segment.parameterAt(distance - startDistances[cursor.segment], cursor.tableIndex);
+    return segment.pointAt(u);
+}
+
+/**
+ * @brief Samples the spline into evenly spaced waypoints for the pure pursuit follower.
+ * @param spacing The distance between waypoints in inches.
+ * @param velocity The target motor speed at every waypoint (0 - 127).
+ * @return The waypoints.
+ */
+std::vector<Waypoint> Spline::toWaypoints(double spacing, double velocity) const {
+    std::vector<Waypoint> waypoints;
+    if (segments.empty() || spacing <= 0) {
+        return waypoints;
+    }
+
+    SplineCursor cursor;
+    size_t count = (size_t)std::ceil(length / spacing);
+    waypoints.reserve(count + 1);
+    for (size_t i = 0; i <= count; i++) {
+        SplinePoint point = pointAt(std::min(i * spacing, length), cursor);
+        waypoints.push_back({point.pose.getX(), point.pose.getY(), velocity});
+    }
+    return waypoints;
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "lib/telemetry.hpp"
+#include "pros/apix.h"
+
+using namespace telemetry_format;
+
+/**
+ * @brief Converts a value to a fixed-point integer, saturating at the limits of int32_t.
+ */
+static int32_t quantize(double value, double scale) {
+    double scaled = std::round(value / scale);
+    if (!std::isfinite(scaled)) {
+        return 0;
+    }
+    return (int32_t)std::clamp(scaled, (double)INT32_MIN, (double)INT32_MAX);
+}
+
+/**
+ * @brief Queues a record for the stream task.
+ * @return False if the queue was full and the record was dropped.
+ */
+bool Telemetry::push(uint8_t type, uint8_t id, std::array<int32_t, 3> values) {
+    uint32_t index = writeIndex.load(std::memory_order_relaxed);
+    do {
+        if (index - readIndex.load(std::memory_order_acquire) >= QUEUE_SIZE) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!writeIndex.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel));
+
+    Entry &entry = entries[index % QUEUE_SIZE];
+    entry.type = type;
+    entry.id = id;
+    entry.time = pros::micros();
+    entry.values = values;
+    entry.ready.store(true, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Logs the robot's pose. Safe to call from any task.
+ * @param pose The pose.
+ */
+void Telemetry::logPose(const Pose &pose) {
+    push(POSE, 0, {quantize(pose.getX(), POSITION_SCALE), quantize(pose.getY(), POSITION_SCALE), quantize(pose.getTheta(), HEADING_SCALE)});
+}
+
+/**
+ * @brief Logs one step of a PID controller. Safe to call from any task.
+ * @param id An id that tells controllers apart in the decoded stream.
+ * @param error The controller's error.
+ * @param output The controller's output.
+ */
+void Telemetry::logPid(uint8_t id, double error, double output) {
+    push(PID, id, {quantize(error, PID_SCALE), quantize(output, PID_SCALE), 0});
+}
+
+/**
+ * @brief Adds a queued record to the packet being built, sending the packet first if the record doesn't fit or has a different type.
+ */
+void Telemetry::append(const Entry &entry) {
+    size_t valueCount = entry.type == POSE ? 3 : 2;
+    size_t maxRecordSize = (valueCount + 1) * MAX_VARINT_SIZE;
+    if (packetSize != 0 && (entry.type != packetType || entry.id != packetId || packetSize + maxRecordSize > packet.size())) {
+        flush();
+    }
+
+    // The first record in a packet is stored in full, so it can be decoded on its own
+    bool first = packetSize == 0;
+    if (first) {
+        packetType = entry.type;
+        packetId = entry.id;
+        packet[packetSize++] = entry.type;
+        if (entry.type == PID) {
+            packet[packetSize++] = entry.id;
+        }
+    }
+
+    packetSize += writeVarint(&packet[packetSize], first ? entry.time : entry.time - lastTime);
+    for (size_t i = 0; i < valueCount; i++) {
+        int32_t value = first ? entry.values[i] : (int32_t)((uint32_t)entry.values[i] - (uint32_t)lastValues[i]);
+        packetSize += writeVarint(&packet[packetSize], zigzag(value));
+    }
+    lastTime = entry.time;
+    lastValues = entry.values;
+}
+
+/**
+ * @brief Sends the packet being built, if any, and starts a new one.
+ */
+void Telemetry::flush() {
+    if (packetSize != 0) {
+        send(packet.data(), packetSize);
+        packetSize = 0;
+    }
+}
+
+/**
+ * @brief Encodes and writes a packet, waiting for the bandwidth limit if needed.
+ * @param data The packet.
+ * @param size The packet's size.
+ */
+void Telemetry::send(const uint8_t *data, size_t size) {
+    std::array<uint8_t, MAX_FRAME_SIZE> frame;
+    size_t frameSize = cobsEncode(data, size, frame.data());
+
+    // Token bucket: bytes become available at maxBytesPerSecond, with at most a tenth of a second saved up
+    while (true) {
+        uint32_t now = pros::millis();
+        availableBytes = std::min(availableBytes + (now - lastRefill) * maxBytesPerSecond / 1000.0, maxBytesPerSecond / 10.0 + MAX_FRAME_SIZE);
+        lastRefill = now;
+        if (availableBytes >= frameSize) {
+            break;
+        }
+        pros::delay(1);
+    }
+
+    fwrite(frame.data(), 1, frameSize, stdout);
+    availableBytes -= frameSize;
+}
+
+/**
+ * @brief Sends the latest motor record from the sampler, if there is a new one.
+ */
+void Telemetry::sendMotors() {
+    MotorRecord record;
+    if (motorSampler == nullptr || motorSampler->getRecordCount() == lastMotorRecord || !motorSampler->getLatest(record)) {
+        return;
+    }
+    lastMotorRecord = motorSampler->getRecordCount();
+
+    std::array<uint8_t, MAX_PACKET_SIZE> motors;
+    size_t size = 0;
+    motors[size++] = MOTORS;
+    size += writeVarint(&motors[size], record.timestamp * 1000);
+    size_t countIndex = size++;
+
+    // Each motor takes at most 3 varints of 16-bit values and 2 single bytes
+    const size_t maxMotorSize = 3 * 3 + 2;
+    size_t count = 0;
+    for (size_t i = 0; i < record.motorCount && size + maxMotorSize <= motors.size(); i++, count++) {
+        const MotorSample &sample = record.motors[i];
+        motors[size++] = sample.flags;
+        size += writeVarint(&motors[size], zigzag(sample.velocity));
+        size += writeVarint(&motors[size], zigzag(sample.currentDraw));
+        size += writeVarint(&motors[size], zigzag(sample.voltage));
+        motors[size++] = sample.temperature;
+    }
+    motors[countIndex] = (uint8_t)count;
+
+    flush();
+    send(motors.data(), size);
+}
+
+/**
+ * @brief Starts the stream task if it is not already running.
+ * If the stream was just stopped, this waits for the previous task to finish its last pass, so two tasks never write at once.
+ * @param priority The task priority. Keep it below the control tasks.
+ */
+void Telemetry::start(uint32_t priority) {
+    if (running) {
+        return;
+    }
+    // The previous task only notices stop() when it wakes up, which can take up to a period
+    while (!stopped) {
+        pros::delay(1);
+    }
+    running = true;
+    stopped = false;
+
+    // Send raw bytes instead of wrapping stdout in the PROS terminal's own framing
+    pros::c::serctl(SERCTL_DISABLE_COBS, nullptr);
+
+    pros::Task task([this] {
+        const uint32_t period = 5; // in milliseconds
+        uint32_t loopTime = pros::millis();
+        lastRefill = loopTime;
+        while (running) {
+            uint32_t index = readIndex.load(std::memory_order_relaxed);
+            while (index != writeIndex.load(std::memory_order_acquire)) {
+                Entry &entry = entries[index % QUEUE_SIZE];
+                // A producer reserved this slot but hasn't finished writing it yet
+                if (!entry.ready.load(std::memory_order_acquire)) {
+                    break;
+                }
+                append(entry);
+                entry.ready.store(false, std::memory_order_relaxed);
+                readIndex.store(++index, std::memory_order_release);
+            }
+
+            uint32_t dropped = droppedCount.load(std::memory_order_relaxed);
+            if (dropped != reportedDrops) {
+                std::array<uint8_t, 1 + MAX_VARINT_SIZE> report;
+                report[0] = DROPPED;
+                size_t size = 1 + writeVarint(&report[1], dropped - reportedDrops);
+                flush();
+                send(report.data(), size);
+                reportedDrops = dropped;
+            }
+
+            sendMotors();
+            flush();
+            fflush(stdout);
+            pros::Task::delay_until(&loopTime, period);
+        }
+        stopped = true;
+    }, priority, TASK_STACK_DEPTH_DEFAULT, "Telemetry");
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cmath>
+#include "lib/thermalgovernor.hpp"
+#include "pros/rtos.hpp"
+
+/**
+ * @brief Sets the time left in the match, so the current limits only need to last until its end.
+ * @param duration The time left in milliseconds.
+ */
+void ThermalGovernor::startMatch(uint32_t duration) {
+    matchEnd = pros::millis() + duration;
+    if (matchEnd == 0) {
+        matchEnd = 1;
+    }
+}
+
+/**
+ * @brief Updates the temperature estimates from the latest sample, and the current limits if they changed.
+ */
+void ThermalGovernor::update() {
+    MotorRecord record;
+    if (drivetrain == nullptr || sampler == nullptr || !sampler->getLatest(record) || record.timestamp == lastTimestamp) {
+        return;
+    }
+
+    // Start from the reported temperatures the first time, and whenever the motors change
+    if (!initialized || record.motorCount != motorCount) {
+        motorCount = record.motorCount;
+        for (size_t i = 0; i < motorCount; i++) {
+            temperatures[i] = record.motors[i].isConnected() ? record.motors[i].temperature : params.ambientTemperature;
+        }
+        groupLimits.fill(0);
+        lastTimestamp = record.timestamp;
+        initialized = true;
+        return;
+    }
+
+    double dt = (record.timestamp - lastTimestamp) / 1000.0;
+    lastTimestamp = record.timestamp;
+
+    double horizon = params.horizon;
+    if (matchEnd != 0) {
+        horizon = std::max((int32_t)(matchEnd - pros::millis()), (int32_t)0) / 1000.0;
+    }
+
+    std::array<int32_t, Drivetrain::MAX_MOTOR_GROUPS> limits;
+    limits.fill(params.maxCurrentLimit);
+    size_t groupCount = 0;
+    for (size_t i = 0; i < motorCount; i++) {
+        const MotorSample &sample = record.motors[i];
+        if (!sample.isConnected()) {
+            currents[i] = 0;
+            continue;
+        }
+
+        // Integrate the RC model, then pull the estimate towards the motor's own (coarse) reading
+        currents[i] = std::abs(sample.currentDraw) / 1000.0;
+        temperatures[i] = model.step(temperatures[i], currents[i], dt);
+        temperatures[i] = model.correct(temperatures[i], sample.temperature, dt);
+
+        size_t group = sample.getGroup();
+        if (group >= limits.size()) {
+            continue;
+        }
+        groupCount = std::max(groupCount, group + 1);
+        limits[group] = std::min(limits[group], model.getCurrentLimit(temperatures[i], horizon));
+    }
+
+    // Only send limits that moved noticeably, so the motors aren't flooded with commands
+    const int32_t minChange = 50; // in milliamps
+    for (size_t group = 0; group < groupCount; group++) {
+        int32_t limit = limits[group];
+        if (groupLimits[group] == 0 || std::abs(limit - groupLimits[group]) >= minChange) {
+            if (params.applyLimits) {
+                drivetrain->setCurrentLimit(group, limit);
+            }
+            groupLimits[group] = limit;
+        }
+    }
+}
+
+/**
+ * @brief Predicts how long a motor can keep its current draw before it throttles itself.
+ * @param motor The motor's index in the sampler's records.
+ * @return The time in seconds, 0 if it is already throttling, or infinity if it never will at this current.
+ */
+double ThermalGovernor::getTimeToThrottle(size_t motor) const {
+    if (motor >= motorCount) {
+        return INFINITY;
+    }
+    return model.getTimeToThrottle(temperatures[motor], currents[motor]);
+}
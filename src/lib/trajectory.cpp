@@ -0,0 +1,162 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "lib/trajectory.hpp"
+#include "util/angle.hpp"
+
+/**
+ * @brief Construct a new Trajectory object from data linked into the program. The data is not copied.
+ * @param buffer The raw trajectory data.
+ * @param size The size of the data in bytes.
+ */
+Trajectory::Trajectory(const uint8_t *buffer, size_t size) {
+    parse(buffer, size);
+}
+
+/**
+ * @brief Loads a trajectory from a file, e.g. "/usd/skills1.traj".
+ * @param path The path to the file.
+ * @return True if the file was read and is a valid trajectory, false otherwise.
+ */
+bool Trajectory::load(const char *path) {
+    valid = false;
+
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return false;
+    }
+
+    // Read the header first so the whole file can be read in one call
+    TrajectoryHeader fileHeader;
+    if (fread(&fileHeader, sizeof(fileHeader), 1, file) != 1) {
+        fclose(file);
+        return false;
+    }
+
+    // Check the header before trusting sampleCount with an allocation, and make sure the file really holds that many samples
+    long fileSize = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        fileSize = ftell(file);
+    }
+    if (memcmp(fileHeader.magic, trajectory_format::MAGIC, sizeof(fileHeader.magic)) != 0 ||
+        fileHeader.version != trajectory_format::VERSION ||
+        fileHeader.sampleTime == 0 || fileHeader.sampleCount == 0 || fileSize < 0 ||
+        ((size_t)fileSize - sizeof(TrajectoryHeader)) / sizeof(TrajectorySample) < fileHeader.sampleCount ||
+        fseek(file, sizeof(TrajectoryHeader), SEEK_SET) != 0) {
+        fclose(file);
+        return false;
+    }
+
+    size_t size = sizeof(TrajectoryHeader) + (size_t)fileHeader.sampleCount * sizeof(TrajectorySample);
+    externalData = nullptr;
+    storage.resize(size);
+    memcpy(storage.data(), &fileHeader, sizeof(fileHeader));
+    size_t samplesRead = fread(storage.data() + sizeof(fileHeader), sizeof(TrajectorySample), fileHeader.sampleCount, file);
+    fclose(file);
+
+    if (samplesRead != fileHeader.sampleCount) {
+        storage.clear();
+        return false;
+    }
+
+    parse(storage.data(), storage.size());
+    return valid;
+}
+
+/**
+ * @brief Validates the header and points the trajectory at the data.
+ * @param buffer The raw trajectory data.
+ * @param size The size of the data in bytes.
+ */
+void Trajectory::parse(const uint8_t *buffer, size_t size) {
+    valid = false;
+    if (!buffer || size < sizeof(TrajectoryHeader)) {
+        return;
+    }
+
+    memcpy(&header, buffer, sizeof(header));
+    if (memcmp(header.magic, trajectory_format::MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != trajectory_format::VERSION ||
+        header.sampleTime == 0 || header.sampleCount == 0 ||
+        size < sizeof(TrajectoryHeader) + (size_t)header.sampleCount * sizeof(TrajectorySample)) {
+        return;
+    }
+
+    if (buffer != storage.data()) {
+        externalData = buffer;
+    }
+    valid = true;
+}
+
+/**
+ * @brief Get the start of the sample data. Looked up on every access so copies of the trajectory stay valid.
+ */
+const uint8_t *Trajectory::samples() const {
+    const uint8_t *buffer = storage.empty() ? externalData : storage.data();
+    return buffer + sizeof(TrajectoryHeader);
+}
+
+/**
+ * @brief Decodes a single sample.
+ * @param index The index of the sample.
+ * @return The decoded sample.
+ */
+TrajectoryPoint Trajectory::decode(size_t index) const {
+    // The data may not be aligned, so copy the sample out instead of casting
+    TrajectorySample sample;
+    memcpy(&sample, samples() + index * sizeof(TrajectorySample), sizeof(sample));
+
+    TrajectoryPoint point;
+    point.pose = Pose(sample.x * trajectory_format::POSITION_SCALE,
+                      sample.y * trajectory_format::POSITION_SCALE,
+                      sample.theta * trajectory_format::HEADING_SCALE);
+    point.velocity = sample.velocity * trajectory_format::VELOCITY_SCALE;
+    point.angularVelocity = sample.angularVelocity * trajectory_format::ANGULAR_VELOCITY_SCALE;
+    point.acceleration = sample.acceleration * trajectory_format::ACCELERATION_SCALE;
+    return point;
+}
+
+/**
+ * @brief Get the duration of the trajectory.
+ * @return The duration in seconds.
+ */
+double Trajectory::getDuration() const {
+    if (!valid) {
+        return 0;
+    }
+    return (header.sampleCount - 1) * header.sampleTime / 1000.0;
+}
+
+/**
+ * @brief Get the state of the trajectory at a point in time. Times outside the trajectory are clamped.
+ * The state is interpolated between the two nearest samples.
+ * @param time The time since the start of the trajectory in seconds.
+ * @return The state at that time.
+ */
+TrajectoryPoint Trajectory::sample(double time) const {
+    if (!valid) {
+        return TrajectoryPoint();
+    }
+
+    double index = time * 1000.0 / header.sampleTime;
+    if (index <= 0) {
+        return decode(0);
+    }
+    if (index >= header.sampleCount - 1) {
+        return decode(header.sampleCount - 1);
+    }
+
+    size_t lower = (size_t)index;
+    double t = index - lower;
+    TrajectoryPoint a = decode(lower);
+    TrajectoryPoint b = decode(lower + 1);
+
+    TrajectoryPoint point;
+    point.pose = Pose(a.pose.getX() + t * (b.pose.getX() - a.pose.getX()),
+                      a.pose.getY() + t * (b.pose.getY() - a.pose.getY()),
+                      wrapAngle(a.pose.getTheta() + t * angleError(b.pose.getTheta(), a.pose.getTheta())));
+    point.velocity = a.velocity + t * (b.velocity - a.velocity);
+    point.angularVelocity = a.angularVelocity + t * (b.angularVelocity - a.angularVelocity);
+    point.acceleration = a.acceleration + t * (b.acceleration - a.acceleration);
+    return point;
+}
@@ -53,6 +53,17 @@ void autonomous() {}
  * task, not resume it from where it left off.
  */
 void opcontrol() {
+	// To run the drive at a fixed rate and measure its input-to-command latency, replace this loop with a
+	// LoopScheduler (see lib/loopscheduler.hpp), using your own chassis and controller:
+	//
+	//     LoopScheduler scheduler(10);
+	//     scheduler.setDrive([] { chassis.arcade(master.get_analog(ANALOG_LEFT_Y), master.get_analog(ANALOG_RIGHT_X)); }, 10);
+	//     scheduler.add([&scheduler] {
+	//         LoopStats drive = scheduler.getStats(LoopScheduler::DRIVE);
+	//         pros::lcd::print(7, "Drive %lu us avg %lu max, %lu late",
+	//                          (unsigned long)drive.getAverageLatency(), (unsigned long)drive.maxLatency, (unsigned long)drive.deadlineMisses);
+	//     }, 500);
+	//     scheduler.run();
 	while (true) {
 		pros::delay(20);
 	}
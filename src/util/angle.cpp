@@ -0,0 +1,18 @@
+#include <cmath>
+#include "util/angle.hpp"
+
+double degToRad(double degrees) {
+    return degrees * (M_PI / 180.0);
+}
+
+double radToDeg(double radians) {
+    return radians * (180.0 / M_PI);
+}
+
+double wrapAngle(double radians) {
+    return std::remainder(radians, 2 * M_PI);
+}
+
+double angleError(double target, double current) {
+    return wrapAngle(target - current);
+}
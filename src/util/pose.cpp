@@ -19,6 +19,12 @@ double Pose::angleTo(const Pose& other) {
     return std::atan2(dy, dx);
 }
 
+double Pose::headingTo(const Pose& other) {
+    double dx = other.getX() - x;
+    double dy = other.getY() - y;
+    return std::atan2(-dx, dy);
+}
+
 Pose Pose::rotate(double angle) {
     double magnitude = sqrt((x*x) + (y*y));
     double theta = (atan2(x, y));
@@ -0,0 +1,215 @@
+/**
+ * Black box log tool.
+ *
+ * Indexes and slices match logs recorded by BlackBox (see lib/blackboxformat.hpp). Times are in seconds since the log was started.
+ * Padding records are skipped, and a log cut off partway through is read up to its last whole record.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/blackbox.cpp -o blackbox
+ *
+ * Usage:
+ *     blackbox index <log.bbx>
+ *         Prints the number of records of each type, the time range, and the file offset of the first record in each second.
+ *     blackbox slice <log.bbx> <start> <end> <output.bbx>
+ *         Writes the records from start to end seconds to a new log, which this tool can read again.
+ *     blackbox csv <log.bbx> <output.csv> [start end]
+ *         Writes the records, or only those from start to end seconds, to a CSV file.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "lib/blackboxformat.hpp"
+
+using namespace blackbox_format;
+
+struct Log {
+    BlackBoxHeader header;
+    std::vector<BlackBoxRecord> records; // Without padding
+    std::vector<long> offsets; // File offset of each record
+    std::vector<double> times; // Seconds since the log was started
+};
+
+static const char *TYPE_NAMES[] = {"padding", "pose", "command", "sensor", "motor", "event"};
+
+/**
+ * @brief Reads a log.
+ * @return False if the file can't be opened or isn't a log this tool understands.
+ */
+static bool readLog(const char *path, Log &log) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Couldn't open %s\n", path);
+        return false;
+    }
+    if (fread(&log.header, sizeof(log.header), 1, file) != 1 || std::memcmp(log.header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        fprintf(stderr, "%s isn't a black box log\n", path);
+        fclose(file);
+        return false;
+    }
+    if (log.header.version != VERSION || log.header.recordSize != sizeof(BlackBoxRecord) || log.header.blockSize % sizeof(BlackBoxRecord) != 0) {
+        fprintf(stderr, "%s has an unsupported version (%u)\n", path, log.header.version);
+        fclose(file);
+        return false;
+    }
+    fseek(file, log.header.blockSize, SEEK_SET);
+
+    // Record times are 32-bit microseconds, which wrap after about 71 minutes. Steps are signed, since records logged
+    // by different tasks at nearly the same time may be slightly out of order
+    int64_t time = 0;
+    uint32_t lastTime = 0;
+    bool first = true;
+    BlackBoxRecord record;
+    long offset = ftell(file);
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        if (record.type != PADDING) {
+            time = first ? record.time : time + (int32_t)(record.time - lastTime);
+            lastTime = record.time;
+            first = false;
+            log.records.push_back(record);
+            log.offsets.push_back(offset);
+            log.times.push_back((time - (int64_t)log.header.startTime * 1000) / 1e6);
+        }
+        offset += sizeof(record);
+    }
+    fclose(file);
+    return true;
+}
+
+/**
+ * @brief Reads a time range from the command line.
+ * @return False if the arguments aren't a valid range.
+ */
+static bool readRange(const char *startArg, const char *endArg, double &start, double &end) {
+    char *startEnd;
+    char *endEnd;
+    start = strtod(startArg, &startEnd);
+    end = strtod(endArg, &endEnd);
+    if (*startEnd != '\0' || *endEnd != '\0' || end < start) {
+        fprintf(stderr, "Invalid time range %s to %s\n", startArg, endArg);
+        return false;
+    }
+    return true;
+}
+
+static int printIndex(const Log &log) {
+    unsigned long counts[sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0])] = {};
+    unsigned long unknown = 0;
+    for (const BlackBoxRecord &record : log.records) {
+        if (record.type < sizeof(counts) / sizeof(counts[0])) {
+            counts[record.type]++;
+        } else {
+            unknown++;
+        }
+    }
+
+    printf("%zu records", log.records.size());
+    if (!log.records.empty()) {
+        printf(" from %.3f s to %.3f s", log.times.front(), log.times.back());
+    }
+    printf("\n");
+    for (size_t type = 1; type < sizeof(counts) / sizeof(counts[0]); type++) {
+        printf("  %-8s %lu\n", TYPE_NAMES[type], counts[type]);
+    }
+    if (unknown != 0) {
+        printf("  unknown  %lu\n", unknown);
+    }
+
+    printf("second,offset\n");
+    long second = -1;
+    for (size_t i = 0; i < log.records.size(); i++) {
+        long recordSecond = (long)log.times[i];
+        if (recordSecond > second) {
+            second = recordSecond;
+            printf("%ld,%ld\n", second, log.offsets[i]);
+        }
+    }
+    return 0;
+}
+
+static int sliceLog(const Log &log, double start, double end, const char *path) {
+    FILE *output = fopen(path, "wb");
+    if (!output) {
+        fprintf(stderr, "Couldn't create %s\n", path);
+        return 1;
+    }
+
+    std::vector<uint8_t> block(log.header.blockSize, 0);
+    std::memcpy(block.data(), &log.header, sizeof(log.header));
+    fwrite(block.data(), 1, block.size(), output);
+
+    // Records are written back to back, and the last block is filled with padding
+    size_t count = 0;
+    for (size_t i = 0; i < log.records.size(); i++) {
+        if (log.times[i] >= start && log.times[i] <= end) {
+            fwrite(&log.records[i], sizeof(BlackBoxRecord), 1, output);
+            count++;
+        }
+    }
+    size_t recordsPerBlock = log.header.blockSize / sizeof(BlackBoxRecord);
+    BlackBoxRecord padding = {};
+    for (size_t i = count % recordsPerBlock; i != 0 && i < recordsPerBlock; i++) {
+        fwrite(&padding, sizeof(padding), 1, output);
+    }
+
+    fclose(output);
+    printf("Wrote %zu records to %s\n", count, path);
+    return 0;
+}
+
+static int writeCsv(const Log &log, double start, double end, const char *path) {
+    FILE *output = fopen(path, "w");
+    if (!output) {
+        fprintf(stderr, "Couldn't create %s\n", path);
+        return 1;
+    }
+
+    fprintf(output, "time_s,type,id,v0,v1,v2,v3,v4,v5\n");
+    for (size_t i = 0; i < log.records.size(); i++) {
+        if (log.times[i] < start || log.times[i] > end) {
+            continue;
+        }
+        const BlackBoxRecord &record = log.records[i];
+        if (record.type < sizeof(TYPE_NAMES) / sizeof(TYPE_NAMES[0])) {
+            fprintf(output, "%.6f,%s,%u", log.times[i], TYPE_NAMES[record.type], record.id);
+        } else {
+            fprintf(output, "%.6f,%u,%u", log.times[i], record.type, record.id);
+        }
+        for (float value : record.values) {
+            fprintf(output, ",%g", value);
+        }
+        fprintf(output, "\n");
+    }
+    fclose(output);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s index <log.bbx>\n", argv[0]);
+        fprintf(stderr, "       %s slice <log.bbx> <start> <end> <output.bbx>\n", argv[0]);
+        fprintf(stderr, "       %s csv <log.bbx> <output.csv> [start end]\n", argv[0]);
+        return 1;
+    }
+
+    Log log;
+    if (!readLog(argv[2], log)) {
+        return 1;
+    }
+
+    double start = -1e300;
+    double end = 1e300;
+    if (std::strcmp(argv[1], "index") == 0) {
+        return printIndex(log);
+    } else if (std::strcmp(argv[1], "slice") == 0 && argc == 6) {
+        return readRange(argv[3], argv[4], start, end) ? sliceLog(log, start, end, argv[5]) : 1;
+    } else if (std::strcmp(argv[1], "csv") == 0 && (argc == 4 || argc == 6)) {
+        if (argc == 6 && !readRange(argv[4], argv[5], start, end)) {
+            return 1;
+        }
+        return writeCsv(log, start, end, argv[3]);
+    }
+
+    fprintf(stderr, "Unknown command or wrong number of arguments\n");
+    return 1;
+}
@@ -0,0 +1,169 @@
+/**
+ * Input curve benchmark.
+ *
+ * Times shaping joystick inputs with the InputCurve lookup table (see lib/inputcurve.hpp) against the switch over the
+ * input scale that Chassis::scaleInput used before, which evaluated the curve's math on every call. Both are checked to give
+ * the same outputs.
+ *
+ * The old version was out of line in chassis.cpp and read the scale from the chassis, so it is kept out of line here.
+ * The lookup is inline in chassis.hpp, as it is on the robot.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/inputcurvebench.cpp -o inputcurvebench
+ *
+ * Usage:
+ *     inputcurvebench [--iterations n]
+ *
+ * Host times are only a guide to the V5: the brain has no hardware double-precision sin or tan, so the old version's
+ * share of a control loop is larger there. For a measured number, time the same calls on the brain with pros::micros().
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "lib/inputcurve.hpp"
+
+enum InputScale {
+    LINEAR,
+    CUBIC,
+    QUINTIC,
+    SIN,
+    SINSQUARED,
+    TAN,
+    XTAN
+};
+
+static const char *NAMES[] = {"LINEAR", "CUBIC", "QUINTIC", "SIN", "SINSQUARED", "TAN", "XTAN"};
+static constexpr InputCurve CURVES[] = {
+    InputCurve::linear(),
+    InputCurve::cubic(),
+    InputCurve::quintic(),
+    InputCurve::sine(),
+    InputCurve::sineSquared(),
+    InputCurve::tangent(),
+    InputCurve::xTangent()
+};
+
+// The table stores floats, so outputs may differ from the old double math by float rounding
+static constexpr double TOLERANCE = 1e-4;
+
+struct OldChassis {
+    InputScale inputScale = LINEAR;
+};
+
+/**
+ * @brief The old Chassis::scaleInput, unchanged apart from reading the scale from a parameter.
+ */
+__attribute__((noinline)) static double oldScaleInput(const OldChassis &chassis, int input) {
+    double normalizedInput = (double)input / 127.0;
+    double scaledInput = 0.0;
+
+    bool isNegative = normalizedInput < 0;
+
+    switch (chassis.inputScale) {
+        case LINEAR:
+            scaledInput = normalizedInput;
+            break;
+        case CUBIC:
+            scaledInput = normalizedInput * normalizedInput * normalizedInput;
+            break;
+        case QUINTIC:
+            scaledInput = normalizedInput * normalizedInput * normalizedInput * normalizedInput * normalizedInput;
+            break;
+        case SIN:
+            scaledInput = sin((normalizedInput * M_PI) / 2);
+            break;
+        case SINSQUARED:
+            scaledInput = sin((normalizedInput * M_PI) / 2);
+            scaledInput = scaledInput * scaledInput;
+            break;
+        case TAN:
+            scaledInput = tan(normalizedInput);
+            break;
+        case XTAN:
+            scaledInput = normalizedInput * tan(normalizedInput);
+            break;
+        default:
+            scaledInput = normalizedInput;
+    }
+
+    if (isNegative && scaledInput > 0) {
+        scaledInput = -scaledInput;
+    }
+
+    return scaledInput * 127.0;
+}
+
+static double now() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Times a function over the inputs, keeping the fastest of several runs to remove the noise of the host operating system.
+ * @return The time per call in nanoseconds.
+ */
+template <typename Function>
+static double timeCalls(const std::vector<int> &inputs, int iterations, Function function) {
+    double best = 1e300;
+    volatile double sink = 0;
+    for (int run = 0; run < 5; run++) {
+        double total = 0;
+        double start = now();
+        for (int i = 0; i < iterations; i++) {
+            for (int input : inputs) {
+                total += function(input);
+            }
+        }
+        best = std::min(best, (now() - start) / ((double)iterations * inputs.size()));
+        sink = sink + total;
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+    int iterations = 2000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--iterations") iterations = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "Usage: %s [--iterations n]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (argc % 2 == 0 || iterations <= 0) {
+        fprintf(stderr, "Usage: %s [--iterations n]\n", argv[0]);
+        return 1;
+    }
+
+    // Stick readings in a scrambled order, so neither version benefits from consecutive inputs
+    std::vector<int> inputs;
+    uint32_t state = 12345;
+    for (int i = 0; i < 1024; i++) {
+        state = state * 1664525 + 1013904223;
+        inputs.push_back((int)(state >> 16) % 255 - 127);
+    }
+
+    bool pass = true;
+    printf("%-12s %12s %12s %9s %12s\n", "curve", "switch (ns)", "table (ns)", "speedup", "max diff");
+    for (int scale = LINEAR; scale <= XTAN; scale++) {
+        OldChassis chassis;
+        chassis.inputScale = (InputScale)scale;
+        const InputCurve &curve = CURVES[scale];
+
+        double maxDifference = 0;
+        for (int input = -InputCurve::MAX_JOYSTICK; input <= InputCurve::MAX_JOYSTICK; input++) {
+            maxDifference = std::max(maxDifference, std::abs(oldScaleInput(chassis, input) - curve(input)));
+        }
+        pass &= maxDifference < TOLERANCE;
+
+        double oldTime = timeCalls(inputs, iterations, [&chassis](int input) { return oldScaleInput(chassis, input); });
+        double newTime = timeCalls(inputs, iterations, [&curve](int input) { return curve(input); });
+        printf("%-12s %12.2f %12.2f %8.1fx %12.2g%s\n", NAMES[scale], oldTime, newTime, oldTime / newTime, maxDifference,
+               maxDifference < TOLERANCE ? "" : "  MISMATCH");
+    }
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+/**
+ * Holonomic mixer check.
+ *
+ * Sweeps the whole joystick space (left stick x and y, right stick x) through HolonomicMixer (see lib/holonomicmixer.hpp)
+ * for several rotation priorities, and checks that desaturation never changes the direction the robot drives in:
+ *  - no wheel is asked for more than full speed,
+ *  - the translation keeps its direction and only ever shrinks,
+ *  - the rotation keeps its sign, only ever shrinks, and keeps at least its guaranteed share of the motor range,
+ *  - commands that fit are sent unchanged.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/mixercheck.cpp -o mixercheck
+ *
+ * Usage:
+ *     mixercheck
+ * It prints the first few failures and exits with 1 if any check failed.
+ */
+#include <cmath>
+#include <cstdio>
+#include "lib/holonomicmixer.hpp"
+
+static constexpr double TOLERANCE = 1e-9;
+static constexpr double PRIORITIES[] = {0, 0.25, 0.5, 0.75, 1};
+
+static unsigned long failures = 0;
+
+static void fail(const char *check, int x, int y, int r, double priority) {
+    if (failures++ < 10) {
+        printf("FAIL %s: stick (%d, %d), rotation %d, priority %.2f\n", check, x, y, r, priority);
+    }
+}
+
+int main() {
+    unsigned long cases = 0;
+    unsigned long saturated = 0;
+
+    for (double priority : PRIORITIES) {
+        for (int x = -127; x <= 127; x++) {
+            for (int y = -127; y <= 127; y++) {
+                for (int r = -127; r <= 127; r += 2) {
+                    cases++;
+                    // The same conversion robotCentricDrive makes, with a linear input curve
+                    double angle = std::atan2(y, x);
+                    double speed = std::hypot(x, y);
+                    std::array<double, 4> wheels = HolonomicMixer::mix(angle, speed, r, priority);
+
+                    for (double wheel : wheels) {
+                        if (std::abs(wheel) > HolonomicMixer::MAX_SPEED + TOLERANCE) {
+                            fail("wheel over full speed", x, y, r, priority);
+                            break;
+                        }
+                    }
+
+                    // Undo the mixing to get the translation and rotation the wheels produce
+                    double outX = (wheels[0] + wheels[1] - wheels[2] - wheels[3]) / 4;
+                    double outY = (wheels[0] - wheels[1] + wheels[2] - wheels[3]) / 4;
+                    double outR = (wheels[0] + wheels[1] + wheels[2] + wheels[3]) / 4;
+                    double inX = std::cos(angle) * speed;
+                    double inY = std::sin(angle) * speed;
+
+                    bool fits = std::abs(inX) + std::abs(inY) + std::abs(r) <= HolonomicMixer::MAX_SPEED;
+                    if (!fits) {
+                        saturated++;
+                    }
+                    if (fits && (std::abs(outX - inX) > TOLERANCE || std::abs(outY - inY) > TOLERANCE || std::abs(outR - r) > TOLERANCE)) {
+                        fail("command that fits was changed", x, y, r, priority);
+                    }
+
+                    // Same direction: no sideways component, not reversed, and no longer than requested
+                    double outSpeed = std::hypot(outX, outY);
+                    if (std::abs(inX * outY - inY * outX) > TOLERANCE * speed * HolonomicMixer::MAX_SPEED ||
+                        inX * outX + inY * outY < -TOLERANCE || outSpeed > speed + TOLERANCE) {
+                        fail("translation direction changed", x, y, r, priority);
+                    }
+                    // Translation only disappears when rotation uses the whole range
+                    if (speed > 0 && outSpeed < TOLERANCE && std::abs(outR) < HolonomicMixer::MAX_SPEED - TOLERANCE) {
+                        fail("translation dropped", x, y, r, priority);
+                    }
+
+                    double guaranteed = std::min((double)std::abs(r), priority * HolonomicMixer::MAX_SPEED);
+                    if (outR * r < -TOLERANCE || std::abs(outR) > std::abs(r) + TOLERANCE || std::abs(outR) < guaranteed - TOLERANCE) {
+                        fail("rotation outside its share", x, y, r, priority);
+                    }
+                }
+            }
+        }
+    }
+
+    printf("%lu cases (%lu saturated), %lu failures\n", cases, saturated, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/**
+ * Path planner benchmark.
+ *
+ * Times PathPlanner on the Push Back field (see lib/occupancygrid.hpp): A* queries planned from scratch, and D* Lite repairs
+ * while an opposing robot drives across the field in front of ours.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/plannerbench.cpp src/lib/pathplanner.cpp src/lib/occupancygrid.cpp -o plannerbench
+ *
+ * Usage:
+ *     plannerbench [--slowdown factor] [--iterations n]
+ *
+ * The planner's budget on the robot is 5 ms per query. The V5 brain's Cortex-A9 runs at 667 MHz, so that is about 3.3 million cycles.
+ * The A* row for the repair queries is only a comparison, since the robot would use the repair for those. The repair is checked
+ * against it instead: it has to take less time in total and in the worst step.
+ * Host times are multiplied by the slowdown (default 15, a conservative ratio between a desktop core and the brain for this
+ * branchy, cache-bound code) to estimate V5 times, which are checked against the budget.
+ * For a measured number, time the same queries on the brain with pros::micros().
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "lib/occupancygrid.hpp"
+#include "lib/pathplanner.hpp"
+
+static constexpr double BUDGET = 5000; // in microseconds, on the V5
+
+struct Query {
+    const char *name;
+    double startX;
+    double startY;
+    double goalX;
+    double goalY;
+};
+
+// Typical queries on a field centered on (0, 0), with the alliance walls along x = +-72
+static const Query QUERIES[] = {
+    {"corner to corner", -60, -60, 60, 60},
+    {"across the center goals", -40, 0, 40, 0},
+    {"into a corner behind a long goal", 40, -30, -45, 60},
+    {"between the long goals", -50, 30, 50, -30},
+    {"short hop", -24, -24, -12, -20},
+};
+
+/**
+ * Times of a set of queries. Each query is run many times and only its fastest run is kept, which removes the noise
+ * of the host operating system. The planner itself is deterministic, and on the robot it runs in a task nothing else preempts.
+ */
+struct Timing {
+    std::vector<double> best; // in microseconds, for each query
+
+    void add(size_t query, double time) {
+        if (query >= best.size()) {
+            best.resize(query + 1, 1e300);
+        }
+        best[query] = std::min(best[query], time);
+    }
+
+    double mean() const {
+        double total = 0;
+        for (double time : best) {
+            total += time;
+        }
+        return total / best.size();
+    }
+
+    double worst() const { return *std::max_element(best.begin(), best.end()); }
+};
+
+static double now() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Prints a row of the results.
+ * @param checked Whether the row is checked against the budget. Rows that are only there for comparison aren't.
+ * @return False if a checked row is over the budget.
+ */
+static bool report(const char *name, const Timing &timing, size_t waypoints, double slowdown, bool checked = true) {
+    double estimate = timing.worst() * slowdown;
+    bool pass = estimate < BUDGET;
+    printf("%-34s %5zu %9.1f %9.1f %11.0f  %s\n", name, waypoints, timing.mean(), timing.worst(), estimate,
+           !checked ? "(comparison)" : (pass ? "ok" : "OVER"));
+    return pass || !checked;
+}
+
+int main(int argc, char **argv) {
+    double slowdown = 15;
+    int iterations = 200;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--slowdown") slowdown = atof(argv[i + 1]);
+        else if (option == "--iterations") iterations = atoi(argv[i + 1]);
+        else {
+            fprintf(stderr, "Usage: %s [--slowdown factor] [--iterations n]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (slowdown <= 0 || iterations <= 0) {
+        fprintf(stderr, "The slowdown and iterations must be positive\n");
+        return 1;
+    }
+
+    static OccupancyGrid grid(9);
+    grid.addPushBackField();
+    static PathPlanner planner(&grid);
+    bool pass = true;
+
+    printf("%-34s %5s %9s %9s %11s\n", "query (times in us)", "wpts", "mean", "worst", "V5 estimate");
+    for (const Query &query : QUERIES) {
+        Timing timing;
+        size_t waypoints = 0;
+        for (int i = 0; i < iterations; i++) {
+            double start = now();
+            std::vector<Waypoint> path = planner.plan(query.startX, query.startY, query.goalX, query.goalY);
+            timing.add(0, now() - start);
+            waypoints = path.size();
+        }
+        if (waypoints == 0) {
+            printf("%-34s found no path\n", query.name);
+            pass = false;
+            continue;
+        }
+        pass &= report(query.name, timing, waypoints, slowdown);
+    }
+
+    // D* Lite: our robot follows its plan corner to corner while an opposing robot drives across in front of it,
+    // and the plan is repaired every step. Each repair is compared with planning the same query from scratch with A*
+    static PathPlanner scratchPlanner(&grid);
+    Timing startTiming;
+    Timing repairTiming;
+    Timing scratchTiming;
+    size_t startWaypoints = 0;
+    size_t waypoints = 0;
+    for (int i = 0; i < iterations; i++) {
+        grid.clearObstacles();
+        double start = now();
+        std::vector<Waypoint> path = planner.startIncremental(-60, -60, 60, 60);
+        startTiming.add(0, now() - start);
+        startWaypoints = path.size();
+
+        for (int step = 0; step < 30 && path.size() > 3; step++) {
+            // Drive 2 waypoints (4 inches) along the plan, while the other robot drives 3 inches across the far half
+            double robotX = path[2].x;
+            double robotY = path[2].y;
+            grid.clearObstacles();
+            grid.addObstacle(50 - step * 3, 25, 9);
+
+            start = now();
+            path = planner.replan(robotX, robotY);
+            double repairTime = now() - start;
+
+            start = now();
+            std::vector<Waypoint> scratchPath = scratchPlanner.plan(robotX, robotY, 60, 60);
+            double scratchTime = now() - start;
+
+            repairTiming.add(step, repairTime);
+            scratchTiming.add(step, scratchTime);
+            if (path.empty() || scratchPath.empty()) {
+                printf("D* Lite or A* found no path at step %d\n", step);
+                return 1;
+            }
+            waypoints = path.size();
+        }
+    }
+
+    pass &= report("D* Lite start", startTiming, startWaypoints, slowdown);
+    pass &= report("D* Lite repair (moving robot)", repairTiming, waypoints, slowdown);
+    report("A* for the same queries", scratchTiming, waypoints, slowdown, false);
+
+    // The repair has to be worth keeping the incremental state for
+    size_t fasterSteps = 0;
+    double repairTotal = 0;
+    double scratchTotal = 0;
+    for (size_t step = 0; step < repairTiming.best.size(); step++) {
+        fasterSteps += repairTiming.best[step] < scratchTiming.best[step];
+        repairTotal += repairTiming.best[step];
+        scratchTotal += scratchTiming.best[step];
+    }
+    bool repairFaster = repairTotal < scratchTotal && repairTiming.worst() < scratchTiming.worst();
+    printf("D* Lite repair was faster than A* in %zu of %zu steps, and took %.0f%% of A*'s total time  %s\n", fasterSteps,
+           repairTiming.best.size(), 100 * repairTotal / scratchTotal, repairFaster ? "ok" : "SLOWER");
+    pass &= repairFaster;
+
+    printf("Budget: %.0f us per query on the V5 (about %.1f million cycles at 667 MHz), estimated with a %.0fx slowdown.\n",
+           BUDGET, BUDGET * 667 / 1e6, slowdown);
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+/**
+ * RAMSETE tracking simulation.
+ *
+ * Drives a simulated differential drive robot along trajectories with the RAMSETE controller (see lib/ramsete.hpp),
+ * the same way DifferentialChassis::followTrajectory does, and reports how far it strays from the path.
+ * The built-in trajectories are an S-curve (a 24 inch lane change over 72 inches) and a figure-eight 72 inches across,
+ * both starting and ending at rest. Trajectory files made with tools/trajgen.cpp can be added on the command line.
+ *
+ * The robot is a unicycle whose wheels reach their commanded velocity with a first-order lag, and which turns slower
+ * than commanded because of wheel scrub. It starts off the trajectory, to the side and turned away from it.
+ * Each trajectory is run with the controller and with the trajectory's velocities alone, to show what the controller corrects.
+ * The cross-track error is the robot's distance to the side of the reference pose, measured every control loop.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/ramsetesim.cpp src/lib/ramsete.cpp src/lib/trajectory.cpp src/util/pose.cpp src/util/angle.cpp -o ramsetesim
+ *
+ * Usage:
+ *     ramsetesim [trajectory files] [options]
+ *
+ * Options:
+ *     --b <value>        RAMSETE b (default 0.0013, as in RamseteParams)
+ *     --zeta <value>     RAMSETE zeta (default 0.7)
+ *     --lag <s>          Time constant of the wheel velocity lag (default 0.08)
+ *     --scrub <ratio>    Fraction of the commanded turn rate the robot achieves (default 0.9)
+ *     --offset <in>      Starting distance to the side of the trajectory (default 2)
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+#include "lib/ramsete.hpp"
+#include "lib/trajectory.hpp"
+#include "util/angle.hpp"
+
+static constexpr double LOOP_TIME = 0.01; // in seconds, as in followTrajectoryLoop
+static constexpr int SUBSTEPS = 10; // Integration steps per control loop
+static constexpr double TRACK_WIDTH = 12; // in inches
+static constexpr double HEADING_OFFSET = 5 * M_PI / 180; // Starting heading error, in radians
+
+struct Plant {
+    double lag = 0.08;
+    double scrub = 0.9;
+    double offset = 2;
+};
+
+struct Reference {
+    std::string name;
+    double duration;
+    std::function<TrajectoryPoint(double)> sample;
+};
+
+struct Result {
+    double maxError = 0;
+    double rmsError = 0;
+    double finalError = 0;
+};
+
+/**
+ * @brief Builds a reference trajectory that follows a shape, timed so it starts and ends at rest.
+ * @param name The name to print.
+ * @param duration How long the trajectory takes, in seconds.
+ * @param shape The position along the shape, for a progress from 0 to 1.
+ */
+static Reference analyticReference(const char *name, double duration, std::function<void(double, double &, double &)> shape) {
+    return {name, duration, [duration, shape](double time) {
+        // Progress along the shape, with zero velocity and acceleration at both ends
+        double s = std::clamp(time / duration, 0.0, 1.0);
+        double u = s * s * s * (10 - 15 * s + 6 * s * s);
+        double du = 30 * s * s * (1 - s) * (1 - s) / duration;
+        double ddu = 60 * s * (1 - s) * (1 - 2 * s) / (duration * duration);
+
+        // Derivatives of the shape by central differences
+        const double h = 1e-4;
+        double x0, y0, x1, y1, x2, y2;
+        shape(u - h, x0, y0);
+        shape(u, x1, y1);
+        shape(u + h, x2, y2);
+        double dx = (x2 - x0) / (2 * h);
+        double dy = (y2 - y0) / (2 * h);
+        double ddx = (x2 - 2 * x1 + x0) / (h * h);
+        double ddy = (y2 - 2 * y1 + y0) / (h * h);
+        double speed = std::hypot(dx, dy);
+
+        // Forward is (-sin(theta), cos(theta))
+        TrajectoryPoint point;
+        point.pose = Pose(x1, y1, atan2(-dx, dy));
+        point.velocity = speed * du;
+        point.angularVelocity = (dx * ddy - dy * ddx) / (speed * speed) * du;
+        point.acceleration = speed * ddu + (dx * ddx + dy * ddy) / speed * du * du;
+        return point;
+    }};
+}
+
+/**
+ * @brief Drives the simulated robot along a trajectory.
+ * @param reference The trajectory.
+ * @param plant The simulated robot.
+ * @param controller The controller, or nullptr to send the trajectory's velocities alone.
+ */
+static Result simulate(const Reference &reference, const Plant &plant, const Ramsete *controller) {
+    TrajectoryPoint start = reference.sample(0);
+    double theta = start.pose.getTheta() + HEADING_OFFSET;
+    // Start to the robot's left of the reference pose, turned further left
+    double x = start.pose.getX() - plant.offset * cos(start.pose.getTheta());
+    double y = start.pose.getY() - plant.offset * sin(start.pose.getTheta());
+    double left = 0;
+    double right = 0;
+
+    Result result;
+    double squaredTotal = 0;
+    int samples = 0;
+    for (double time = 0; time <= reference.duration + 1e-9; time += LOOP_TIME) {
+        TrajectoryPoint target = reference.sample(time);
+
+        // Cross-track error, positive to the reference's left
+        double dx = x - target.pose.getX();
+        double dy = y - target.pose.getY();
+        double error = -dx * cos(target.pose.getTheta()) - dy * sin(target.pose.getTheta());
+        result.maxError = std::max(result.maxError, std::abs(error));
+        result.finalError = std::abs(error);
+        squaredTotal += error * error;
+        samples++;
+
+        ChassisVelocity command = {target.velocity, target.angularVelocity};
+        if (controller != nullptr) {
+            command = controller->calculate(Pose(x, y, theta), target.pose, target.velocity, target.angularVelocity);
+        }
+        double leftCommand = command.linear + command.angular * TRACK_WIDTH / 2;
+        double rightCommand = command.linear - command.angular * TRACK_WIDTH / 2;
+
+        double step = LOOP_TIME / SUBSTEPS;
+        for (int i = 0; i < SUBSTEPS; i++) {
+            double response = plant.lag > 0 ? 1 - exp(-step / plant.lag) : 1;
+            left += (leftCommand - left) * response;
+            right += (rightCommand - right) * response;
+
+            double linear = (left + right) / 2;
+            double angular = (left - right) / TRACK_WIDTH * plant.scrub;
+            x += -linear * sin(theta) * step;
+            y += linear * cos(theta) * step;
+            theta += angular * step;
+        }
+    }
+
+    result.rmsError = std::sqrt(squaredTotal / samples);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    RamseteParams params;
+    Plant plant;
+    std::vector<Reference> references;
+    std::vector<Trajectory> files;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; i++) {
+        std::string option = argv[i];
+        if (option.rfind("--", 0) != 0) {
+            paths.push_back(option);
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", option.c_str());
+            return 1;
+        }
+        double value = atof(argv[++i]);
+        if (option == "--b") params.b = value;
+        else if (option == "--zeta") params.zeta = value;
+        else if (option == "--lag") plant.lag = value;
+        else if (option == "--scrub") plant.scrub = value;
+        else if (option == "--offset") plant.offset = value;
+        else {
+            fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 1;
+        }
+    }
+    if (params.b <= 0 || params.zeta <= 0 || params.zeta >= 1 || plant.lag < 0 || plant.scrub <= 0) {
+        fprintf(stderr, "b must be positive, zeta between 0 and 1, the lag at least 0 and the scrub positive\n");
+        return 1;
+    }
+
+    references.push_back(analyticReference("S-curve", 3, [](double u, double &x, double &y) {
+        x = -12 * (1 - cos(M_PI * u));
+        y = 72 * u;
+    }));
+    references.push_back(analyticReference("figure-eight", 10, [](double u, double &x, double &y) {
+        x = -18 * sin(4 * M_PI * u);
+        y = 36 * sin(2 * M_PI * u);
+    }));
+
+    // Reserved up front, so the references can keep pointers to the loaded trajectories
+    files.reserve(paths.size());
+    for (const std::string &path : paths) {
+        files.emplace_back();
+        if (!files.back().load(path.c_str())) {
+            fprintf(stderr, "Couldn't read a trajectory from %s\n", path.c_str());
+            return 1;
+        }
+        const Trajectory *trajectory = &files.back();
+        references.push_back({path, trajectory->getDuration(), [trajectory](double time) { return trajectory->sample(time); }});
+    }
+
+    Ramsete controller(params.b, params.zeta);
+    printf("b %.4g, zeta %.2f, wheel lag %.3f s, scrub %.2f, starting %.1f in and %.0f deg off\n",
+           params.b, params.zeta, plant.lag, plant.scrub, plant.offset, HEADING_OFFSET * 180 / M_PI);
+    printf("%-20s %-12s %9s %9s %9s\n", "trajectory", "control", "max (in)", "rms (in)", "final (in)");
+    for (const Reference &reference : references) {
+        Result ramsete = simulate(reference, plant, &controller);
+        Result openLoop = simulate(reference, plant, nullptr);
+        printf("%-20s %-12s %9.2f %9.2f %9.2f\n", reference.name.c_str(), "RAMSETE", ramsete.maxError, ramsete.rmsError, ramsete.finalError);
+        printf("%-20s %-12s %9.2f %9.2f %9.2f\n", "", "open loop", openLoop.maxError, openLoop.rmsError, openLoop.finalError);
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * Telemetry stream decoder.
+ *
+ * Turns a capture of the robot's binary telemetry stream (see lib/telemetryformat.hpp) into CSV files,
+ * one per record type: <prefix>_pose.csv, <prefix>_pid.csv and <prefix>_motors.csv.
+ * Malformed frames are skipped, and decoding picks up again at the next frame.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/telemetry2csv.cpp -o telemetry2csv
+ *
+ * Usage:
+ *     telemetry2csv <capture.bin> <output prefix>
+ *
+ * Capture the stream by saving everything the brain's USB serial port sends to a file, for example with
+ *     cat /dev/ttyACM1 > capture.bin
+ */
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "lib/telemetryformat.hpp"
+
+using namespace telemetry_format;
+
+struct Outputs {
+    FILE *pose;
+    FILE *pid;
+    FILE *motors;
+    unsigned long frames = 0;
+    unsigned long badFrames = 0;
+    unsigned long dropped = 0;
+};
+
+/**
+ * @brief Decodes one packet and writes its records to the CSV files.
+ * @return False if the packet is malformed.
+ */
+static bool decodePacket(const uint8_t *data, size_t size, Outputs &outputs) {
+    if (size == 0) {
+        return false;
+    }
+    size_t offset = 1;
+    uint32_t value;
+    size_t read;
+
+    switch (data[0]) {
+        case POSE:
+        case PID: {
+            bool pose = data[0] == POSE;
+            uint8_t id = 0;
+            if (!pose) {
+                if (offset >= size) {
+                    return false;
+                }
+                id = data[offset++];
+            }
+
+            size_t valueCount = pose ? 3 : 2;
+            uint32_t time = 0;
+            int32_t values[3] = {0, 0, 0};
+            bool first = true;
+            while (offset < size) {
+                if (!(read = readVarint(&data[offset], size - offset, value))) {
+                    return false;
+                }
+                offset += read;
+                time = first ? value : time + value;
+                for (size_t i = 0; i < valueCount; i++) {
+                    if (!(read = readVarint(&data[offset], size - offset, value))) {
+                        return false;
+                    }
+                    offset += read;
+                    values[i] = first ? unzigzag(value) : (int32_t)((uint32_t)values[i] + (uint32_t)unzigzag(value));
+                }
+                first = false;
+
+                if (pose) {
+                    fprintf(outputs.pose, "%u,%.2f,%.2f,%.4f\n", time, values[0] * POSITION_SCALE, values[1] * POSITION_SCALE, values[2] * HEADING_SCALE);
+                } else {
+                    fprintf(outputs.pid, "%u,%u,%.3f,%.3f\n", time, id, values[0] * PID_SCALE, values[1] * PID_SCALE);
+                }
+            }
+            return true;
+        }
+
+        case MOTORS: {
+            if (!(read = readVarint(&data[offset], size - offset, value)) || offset + read >= size) {
+                return false;
+            }
+            offset += read;
+            uint32_t time = value;
+            uint8_t count = data[offset++];
+            for (uint8_t motor = 0; motor < count; motor++) {
+                if (offset >= size) {
+                    return false;
+                }
+                uint8_t flags = data[offset++];
+                int32_t fields[3];
+                for (int32_t &field : fields) {
+                    if (!(read = readVarint(&data[offset], size - offset, value))) {
+                        return false;
+                    }
+                    offset += read;
+                    field = unzigzag(value);
+                }
+                if (offset >= size) {
+                    return false;
+                }
+                uint8_t temperature = data[offset++];
+                fprintf(outputs.motors, "%u,%u,%u,%d,%.1f,%d,%d,%u\n", time, motor, flags >> 4, (flags & 1) == 0,
+                        fields[0] / 10.0, fields[1], fields[2], temperature);
+            }
+            return true;
+        }
+
+        case DROPPED:
+            if (!readVarint(&data[offset], size - offset, value)) {
+                return false;
+            }
+            outputs.dropped += value;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <capture.bin> <output prefix>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *input = fopen(argv[1], "rb");
+    if (!input) {
+        fprintf(stderr, "Couldn't open %s\n", argv[1]);
+        return 1;
+    }
+
+    std::string prefix = argv[2];
+    Outputs outputs;
+    outputs.pose = fopen((prefix + "_pose.csv").c_str(), "w");
+    outputs.pid = fopen((prefix + "_pid.csv").c_str(), "w");
+    outputs.motors = fopen((prefix + "_motors.csv").c_str(), "w");
+    if (!outputs.pose || !outputs.pid || !outputs.motors) {
+        fprintf(stderr, "Couldn't create the output files\n");
+        return 1;
+    }
+    fprintf(outputs.pose, "time_us,x,y,theta\n");
+    fprintf(outputs.pid, "time_us,id,error,output\n");
+    fprintf(outputs.motors, "time_us,motor,group,connected,velocity_rpm,current_ma,voltage_mv,temperature_c\n");
+
+    // Collect bytes until each 0 delimiter, then decode the frame. Frames longer than the format allows are skipped
+    std::vector<uint8_t> frame;
+    uint8_t packet[MAX_FRAME_SIZE];
+    bool overflowed = false;
+    int byte;
+    while ((byte = fgetc(input)) != EOF) {
+        if (byte != 0) {
+            if (frame.size() < MAX_FRAME_SIZE) {
+                frame.push_back((uint8_t)byte);
+            } else {
+                overflowed = true;
+            }
+            continue;
+        }
+
+        if (!frame.empty()) {
+            outputs.frames++;
+            size_t size = overflowed ? 0 : cobsDecode(frame.data(), frame.size(), packet);
+            if (size == 0 || !decodePacket(packet, size, outputs)) {
+                outputs.badFrames++;
+            }
+        }
+        frame.clear();
+        overflowed = false;
+    }
+
+    fclose(input);
+    fclose(outputs.pose);
+    fclose(outputs.pid);
+    fclose(outputs.motors);
+    printf("Decoded %lu frames (%lu malformed). The robot dropped %lu records.\n", outputs.frames, outputs.badFrames, outputs.dropped);
+    return 0;
+}
@@ -0,0 +1,217 @@
+/**
+ * Thermal governor simulation.
+ *
+ * Runs a drivetrain motor through a two-minute match (a 15 second autonomous and a 105 second driver control period),
+ * once with ThermalGovernor's current limits and once without, and compares how much of the driver's demand the motor delivers.
+ * The motor heats up following the same thermal model the governor uses (see lib/thermalmodel.hpp).
+ *
+ * The driver repeatedly accelerates, cruises and stops, with a pushing match against another robot every 20 seconds.
+ * Past the throttle temperature the simulated motor limits itself the way the V5 motor firmware roughly does:
+ * to half its current at the throttle temperature, a quarter 5 degrees above it, and nothing 10 degrees above it.
+ * The governor only sees what it would on the robot: the current draw, and the temperature rounded down to 5 degrees.
+ *
+ * ThermalParams' defaults aren't calibrated, and with their rise coefficient this profile never reaches the throttle temperature.
+ * The simulation defaults to a motor that runs hotter instead, such as one on a drivetrain geared for speed, starting warm
+ * from an earlier match. Pass your own robot's measured values to see what the governor does for it.
+ * The governor gives up some current early in the match, since it plans for the motor drawing its limit the whole time,
+ * in exchange for full power at the end of the match instead of a throttled motor.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/thermalsim.cpp -o thermalsim
+ *
+ * Usage:
+ *     thermalsim [options]
+ *
+ * Options:
+ *     --start <C>        The motor's temperature at the start of the match (default 45)
+ *     --rise <C/A^2>     Steady-state temperature rise per amp squared (default 20)
+ *     --tau <s>          Thermal time constant (default from ThermalParams)
+ *     --correction <s>   Time constant of the correction towards the readings (default from ThermalParams)
+ *     --csv <file>       Also write the time, demand, delivered current and temperature of both runs every second
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "lib/thermalmodel.hpp"
+
+static constexpr double MATCH_TIME = 120; // in seconds
+static constexpr double AUTONOMOUS_TIME = 15;
+static constexpr double STEP = 0.01; // Simulation step in seconds
+static constexpr double UPDATE_PERIOD = 0.1; // How often the governor updates, in seconds
+static constexpr double WINDOW = 15; // Length of the windows the delivered current is averaged over, in seconds
+static constexpr double READING_STEP = 5; // The motor reports its temperature in steps of this many degrees
+
+struct Sample {
+    double demand; // in amps
+    double delivered;
+    double temperature;
+};
+
+/**
+ * @brief The current the driver asks for at a point in the match.
+ * @param time The time since the start of the match in seconds.
+ * @return The current in amps, before any limits.
+ */
+static double demandAt(double time) {
+    if (time < AUTONOMOUS_TIME) {
+        // Short, fast motions with pauses for the mechanisms
+        double phase = std::fmod(time, 3);
+        return phase < 0.4 ? 2.5 : (phase < 2 ? 1.4 : 0.3);
+    }
+    double driverTime = time - AUTONOMOUS_TIME;
+    if (std::fmod(driverTime, 20) >= 15) {
+        // Pushing against another robot, stalled at full power
+        return 2.5;
+    }
+    double phase = std::fmod(driverTime, 4);
+    return phase < 0.6 ? 2.5 : (phase < 3 ? 1.3 : 0.2);
+}
+
+/**
+ * @brief The limit the motor firmware applies to itself when hot.
+ * @param temperature The motor's temperature in degrees Celsius.
+ * @param params The thermal parameters.
+ * @return The current limit in amps.
+ */
+static double firmwareLimit(double temperature, const ThermalParams &params) {
+    double maxCurrent = params.maxCurrentLimit / 1000.0;
+    if (temperature >= params.throttleTemperature + 10) return 0;
+    if (temperature >= params.throttleTemperature + 5) return maxCurrent / 4;
+    if (temperature >= params.throttleTemperature) return maxCurrent / 2;
+    return maxCurrent;
+}
+
+/**
+ * @brief Runs one match.
+ * @param params The thermal parameters, shared by the simulated motor and the governor.
+ * @param startTemperature The motor's temperature at the start of the match.
+ * @param governed Whether the governor limits the current.
+ * @return The state every simulation step.
+ */
+static std::vector<Sample> runMatch(const ThermalParams &params, double startTemperature, bool governed) {
+    ThermalModel model(params);
+    double temperature = startTemperature;
+    // The governor starts from the motor's reading, like ThermalGovernor::update does
+    double estimate = std::floor(temperature / READING_STEP) * READING_STEP;
+    double current = 0;
+    double limit = params.maxCurrentLimit / 1000.0;
+    double nextUpdate = 0;
+
+    std::vector<Sample> samples;
+    for (double time = 0; time < MATCH_TIME - 1e-9; time += STEP) {
+        if (governed && time >= nextUpdate - 1e-9) {
+            // The same steps as ThermalGovernor::update, with the time left in the match as the horizon
+            double reading = std::floor(temperature / READING_STEP) * READING_STEP;
+            if (time > 0) {
+                estimate = model.step(estimate, current, UPDATE_PERIOD);
+                estimate = model.correct(estimate, reading, UPDATE_PERIOD);
+            }
+            limit = model.getCurrentLimit(estimate, MATCH_TIME - time) / 1000.0;
+            nextUpdate += UPDATE_PERIOD;
+        }
+
+        double demand = demandAt(time);
+        current = std::min({demand, limit, firmwareLimit(temperature, params)});
+        temperature = model.step(temperature, current, STEP);
+        samples.push_back({demand, current, temperature});
+    }
+    return samples;
+}
+
+/**
+ * @brief Averages the delivered current over part of the match.
+ * @return The fraction of the demanded current that was delivered.
+ */
+static double deliveredShare(const std::vector<Sample> &samples, double start, double end) {
+    double demand = 0;
+    double delivered = 0;
+    for (size_t i = (size_t)std::lround(start / STEP); i < samples.size() && i < (size_t)std::lround(end / STEP); i++) {
+        demand += samples[i].demand;
+        delivered += samples[i].delivered;
+    }
+    return demand > 0 ? delivered / demand : 1;
+}
+
+/**
+ * @brief Sums the time the motor spent limiting itself.
+ */
+static double throttledTime(const std::vector<Sample> &samples, const ThermalParams &params) {
+    double time = 0;
+    for (const Sample &sample : samples) {
+        if (sample.temperature >= params.throttleTemperature) {
+            time += STEP;
+        }
+    }
+    return time;
+}
+
+int main(int argc, char **argv) {
+    ThermalParams params;
+    params.riseCoefficient = 20;
+    double startTemperature = 45;
+    const char *csvPath = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        if (option == "--start") startTemperature = atof(argv[i + 1]);
+        else if (option == "--rise") params.riseCoefficient = atof(argv[i + 1]);
+        else if (option == "--tau") params.timeConstant = atof(argv[i + 1]);
+        else if (option == "--correction") params.measurementTimeConstant = atof(argv[i + 1]);
+        else if (option == "--csv") csvPath = argv[i + 1];
+        else {
+            fprintf(stderr, "Unknown option %s\n", option.c_str());
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        fprintf(stderr, "Usage: %s [--start C] [--rise C/A^2] [--tau s] [--correction s] [--csv file]\n", argv[0]);
+        return 1;
+    }
+    if (params.riseCoefficient <= 0 || params.timeConstant <= 0) {
+        fprintf(stderr, "The rise coefficient and time constant must be positive\n");
+        return 1;
+    }
+
+    std::vector<Sample> ungoverned = runMatch(params, startTemperature, false);
+    std::vector<Sample> governed = runMatch(params, startTemperature, true);
+
+    printf("Motor starts at %.0f C, throttles at %.0f C (rise %.1f C/A^2, time constant %.0f s)\n",
+           startTemperature, params.throttleTemperature, params.riseCoefficient, params.timeConstant);
+    printf("Share of the demanded current delivered:\n");
+    printf("%-14s %15s %15s\n", "time (s)", "no governor", "governor");
+    for (double start = 0; start < MATCH_TIME - 1e-9; start += WINDOW) {
+        char window[32];
+        snprintf(window, sizeof(window), "%.0f - %.0f", start, start + WINDOW);
+        printf("%-14s %14.0f%% %14.0f%%\n", window, 100 * deliveredShare(ungoverned, start, start + WINDOW),
+               100 * deliveredShare(governed, start, start + WINDOW));
+    }
+
+    double worstUngoverned = 1;
+    double worstGoverned = 1;
+    for (double start = 0; start + 5 <= MATCH_TIME + 1e-9; start += 1) {
+        worstUngoverned = std::min(worstUngoverned, deliveredShare(ungoverned, start, start + 5));
+        worstGoverned = std::min(worstGoverned, deliveredShare(governed, start, start + 5));
+    }
+    printf("%-14s %14.0f%% %14.0f%%\n", "whole match", 100 * deliveredShare(ungoverned, 0, MATCH_TIME), 100 * deliveredShare(governed, 0, MATCH_TIME));
+    printf("%-14s %14.0f%% %14.0f%%\n", "worst 5 s", 100 * worstUngoverned, 100 * worstGoverned);
+    printf("%-14s %13.1f C %13.1f C\n", "final temp", ungoverned.back().temperature, governed.back().temperature);
+    printf("%-14s %13.1f s %13.1f s\n", "throttled", throttledTime(ungoverned, params), throttledTime(governed, params));
+
+    if (csvPath != nullptr) {
+        FILE *csv = fopen(csvPath, "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "Couldn't write %s\n", csvPath);
+            return 1;
+        }
+        fprintf(csv, "time,demand,delivered,temperature,governed delivered,governed temperature\n");
+        size_t stride = (size_t)std::lround(1 / STEP);
+        for (size_t i = 0; i < ungoverned.size(); i += stride) {
+            fprintf(csv, "%.2f,%.3f,%.3f,%.2f,%.3f,%.2f\n", i * STEP, ungoverned[i].demand, ungoverned[i].delivered,
+                    ungoverned[i].temperature, governed[i].delivered, governed[i].temperature);
+        }
+        fclose(csv);
+    }
+    return 0;
+}
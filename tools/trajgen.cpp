@@ -0,0 +1,272 @@
+/**
+ * Offline trajectory generator.
+ *
+ * Turns a list of waypoints into a time-parameterized trajectory in the binary trajectory format (see lib/trajectory.hpp),
+ * so the robot doesn't have to spend time generating trajectories at the start of autonomous.
+ * The trajectory is as fast as possible while respecting the max velocity, acceleration, and centripetal acceleration,
+ * and keeps the outside wheel of a turn under the max velocity for the given track width.
+ *
+ * This runs on a computer, not the robot. Build it with:
+ *     g++ -std=c++20 -O2 -Iinclude tools/trajgen.cpp src/lib/spline.cpp src/util/pose.cpp src/util/angle.cpp -o trajgen
+ *
+ * Usage:
+ *     trajgen <waypoints.txt> <output> [options]
+ *
+ * The waypoint file has one waypoint per line: "x y heading", with x and y in inches and the heading in degrees,
+ * using the same convention as the tracked pose. Lines starting with # are ignored.
+ * Consecutive waypoints are joined by cubic (or quintic) Hermite splines that leave and arrive along the waypoint headings.
+ *
+ * Options:
+ *     --max-vel <in/s>            Max velocity (default 60)
+ *     --max-accel <in/s^2>        Max acceleration (default 120)
+ *     --max-centripetal <in/s^2>  Max centripetal acceleration (default 80)
+ *     --track-width <in>          Drivetrain track width (default 12)
+ *     --dt <ms>                   Sample time (default 10)
+ *     --quintic                   Use quintic Hermite splines for continuous curvature
+ *     --cpp <name>                Write a C++ source file with a const array named <name> instead of a binary file
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "lib/spline.hpp"
+#include "lib/trajectory.hpp"
+#include "util/angle.hpp"
+
+struct PathPoint {
+    double x;
+    double y;
+    double theta;
+    double curvature; // in 1/inches, positive increases the heading
+    double distance; // distance along the path in inches
+};
+
+struct Constraints {
+    double maxVel = 60;
+    double maxAccel = 120;
+    double maxCentripetal = 80;
+    double trackWidth = 12;
+    int sampleTime = 10;
+};
+
+/**
+ * @brief Reads waypoints from a text file.
+ */
+static std::vector<Pose> readWaypoints(const char *path) {
+    std::vector<Pose> waypoints;
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        return waypoints;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        double x, y, heading;
+        if (line[0] != '#' && sscanf(line, "%lf %lf %lf", &x, &y, &heading) == 3) {
+            waypoints.push_back(Pose(x, y, degToRad(heading)));
+        }
+    }
+    fclose(file);
+    return waypoints;
+}
+
+/**
+ * @brief Samples the spline through the waypoints at a small fixed spacing, recording heading, curvature, and distance.
+ */
+static std::vector<PathPoint> samplePath(const std::vector<Pose> &waypoints, bool quintic) {
+    const double spacing = 0.1; // in inches
+    Spline spline(waypoints, quintic);
+    SplineCursor cursor;
+
+    std::vector<PathPoint> points;
+    size_t count = (size_t)std::ceil(spline.getLength() / spacing);
+    for (size_t i = 0; i <= count; i++) {
+        double distance = std::min(i * spacing, spline.getLength());
+        SplinePoint point = spline.pointAt(distance, cursor);
+        points.push_back({point.pose.getX(), point.pose.getY(), point.pose.getTheta(), point.curvature, distance});
+    }
+    return points;
+}
+
+/**
+ * @brief Finds the fastest velocity at every path point that respects the constraints, starting and ending at rest.
+ */
+static std::vector<double> velocityProfile(const std::vector<PathPoint> &points, const Constraints &constraints) {
+    std::vector<double> velocities(points.size());
+
+    // Limits from the path's curvature
+    for (size_t i = 0; i < points.size(); i++) {
+        double curvature = std::abs(points[i].curvature);
+        double limit = constraints.maxVel / (1 + curvature * constraints.trackWidth / 2);
+        if (curvature > 0) {
+            limit = std::min(limit, std::sqrt(constraints.maxCentripetal / curvature));
+        }
+        velocities[i] = limit;
+    }
+    velocities.front() = 0;
+    velocities.back() = 0;
+
+    // Forward pass limits acceleration, backward pass limits deceleration
+    for (size_t i = 1; i < points.size(); i++) {
+        double ds = points[i].distance - points[i - 1].distance;
+        velocities[i] = std::min(velocities[i], std::sqrt(velocities[i - 1] * velocities[i - 1] + 2 * constraints.maxAccel * ds));
+    }
+    for (size_t i = points.size() - 1; i > 0; i--) {
+        double ds = points[i].distance - points[i - 1].distance;
+        velocities[i - 1] = std::min(velocities[i - 1], std::sqrt(velocities[i] * velocities[i] + 2 * constraints.maxAccel * ds));
+    }
+    return velocities;
+}
+
+/**
+ * @brief Converts a value to a fixed-point integer, saturating at the limits of int16_t.
+ */
+static int16_t quantize(double value, double scale) {
+    return (int16_t)std::clamp(std::lround(value / scale), (long)INT16_MIN, (long)INT16_MAX);
+}
+
+/**
+ * @brief Time-parameterizes the path and samples it at a fixed interval into the binary trajectory format.
+ */
+static std::vector<uint8_t> buildTrajectory(const std::vector<PathPoint> &points, const std::vector<double> &velocities, const Constraints &constraints) {
+    // Time at each path point, assuming constant acceleration between points
+    std::vector<double> times(points.size(), 0);
+    for (size_t i = 1; i < points.size(); i++) {
+        double ds = points[i].distance - points[i - 1].distance;
+        double averageVel = (velocities[i] + velocities[i - 1]) / 2;
+        times[i] = times[i - 1] + (averageVel > 0 ? ds / averageVel : 0);
+    }
+
+    std::vector<TrajectorySample> samples;
+    double dt = constraints.sampleTime / 1000.0;
+    size_t i = 0;
+    for (double t = 0; ; t += dt) {
+        t = std::min(t, times.back());
+        while (i + 2 < points.size() && times[i + 1] <= t) {
+            i++;
+        }
+
+        double segmentTime = times[i + 1] - times[i];
+        double u = segmentTime > 0 ? (t - times[i]) / segmentTime : 0;
+        const PathPoint &a = points[i];
+        const PathPoint &b = points[i + 1];
+
+        double velocity = velocities[i] + u * (velocities[i + 1] - velocities[i]);
+        double curvature = a.curvature + u * (b.curvature - a.curvature);
+        double ds = b.distance - a.distance;
+        double acceleration = ds > 0 ? (velocities[i + 1] * velocities[i + 1] - velocities[i] * velocities[i]) / (2 * ds) : 0;
+
+        TrajectorySample sample;
+        sample.x = quantize(a.x + u * (b.x - a.x), trajectory_format::POSITION_SCALE);
+        sample.y = quantize(a.y + u * (b.y - a.y), trajectory_format::POSITION_SCALE);
+        sample.theta = quantize(wrapAngle(a.theta + u * angleError(b.theta, a.theta)), trajectory_format::HEADING_SCALE);
+        sample.velocity = quantize(velocity, trajectory_format::VELOCITY_SCALE);
+        sample.angularVelocity = quantize(velocity * curvature, trajectory_format::ANGULAR_VELOCITY_SCALE);
+        sample.acceleration = quantize(acceleration, trajectory_format::ACCELERATION_SCALE);
+        samples.push_back(sample);
+
+        if (t >= times.back()) {
+            break;
+        }
+    }
+
+    TrajectoryHeader header;
+    memcpy(header.magic, trajectory_format::MAGIC, sizeof(header.magic));
+    header.version = trajectory_format::VERSION;
+    header.sampleTime = constraints.sampleTime;
+    header.sampleCount = samples.size();
+
+    std::vector<uint8_t> bytes(sizeof(header) + samples.size() * sizeof(TrajectorySample));
+    memcpy(bytes.data(), &header, sizeof(header));
+    memcpy(bytes.data() + sizeof(header), samples.data(), samples.size() * sizeof(TrajectorySample));
+    return bytes;
+}
+
+/**
+ * @brief Writes the trajectory as a C++ source file containing a const array, to be linked into the program.
+ */
+static bool writeCpp(const char *path, const char *name, const std::vector<uint8_t> &bytes) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "// Generated by tools/trajgen.cpp\n#include <cstddef>\n#include <cstdint>\n\n");
+    fprintf(file, "extern const uint8_t %s[] = {", name);
+    for (size_t i = 0; i < bytes.size(); i++) {
+        fprintf(file, "%s0x%02x,", i % 16 == 0 ? "\n    " : " ", bytes[i]);
+    }
+    fprintf(file, "\n};\nextern const size_t %s_size = sizeof(%s);\n", name, name);
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <waypoints.txt> <output> [--max-vel v] [--max-accel a] [--max-centripetal c] [--track-width w] [--dt ms] [--quintic] [--cpp name]\n", argv[0]);
+        return 1;
+    }
+
+    Constraints constraints;
+    const char *cppName = nullptr;
+    bool quintic = false;
+    for (int i = 3; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--quintic") {
+            quintic = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            return 1;
+        }
+        if (option == "--max-vel") constraints.maxVel = atof(argv[i + 1]);
+        else if (option == "--max-accel") constraints.maxAccel = atof(argv[i + 1]);
+        else if (option == "--max-centripetal") constraints.maxCentripetal = atof(argv[i + 1]);
+        else if (option == "--track-width") constraints.trackWidth = atof(argv[i + 1]);
+        else if (option == "--dt") constraints.sampleTime = atoi(argv[i + 1]);
+        else if (option == "--cpp") cppName = argv[i + 1];
+        else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+
+    // The sample time is stored in 16 bits, and sampling needs it to move forward
+    if (constraints.sampleTime <= 0 || constraints.sampleTime > UINT16_MAX) {
+        fprintf(stderr, "--dt must be between 1 and %d ms\n", UINT16_MAX);
+        return 1;
+    }
+
+    std::vector<Pose> waypoints = readWaypoints(argv[1]);
+    if (waypoints.size() < 2) {
+        fprintf(stderr, "Need at least 2 waypoints in %s\n", argv[1]);
+        return 1;
+    }
+
+    std::vector<PathPoint> points = samplePath(waypoints, quintic);
+    std::vector<double> velocities = velocityProfile(points, constraints);
+    std::vector<uint8_t> bytes = buildTrajectory(points, velocities, constraints);
+
+    bool written;
+    if (cppName) {
+        written = writeCpp(argv[2], cppName, bytes);
+    } else {
+        FILE *file = fopen(argv[2], "wb");
+        written = file && fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        if (file) {
+            fclose(file);
+        }
+    }
+    if (!written) {
+        fprintf(stderr, "Could not write %s\n", argv[2]);
+        return 1;
+    }
+
+    size_t sampleCount = (bytes.size() - sizeof(TrajectoryHeader)) / sizeof(TrajectorySample);
+    printf("%zu samples, %.2f s, %.1f in, %zu bytes\n", sampleCount, (sampleCount - 1) * constraints.sampleTime / 1000.0, points.back().distance, bytes.size());
+    return 0;
+}